@@ -16,29 +16,72 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "azoteq_iqs7211e.h"
-#include "pointing_device_internal.h"
-#include "wait.h"
-#include "debug.h"
+#include "azoteq_iqs7211e_tracker.h"
+#include "azoteq_iqs7211e_predictor.h"
+#include "azoteq_iqs7211e_rim.h"
+#include "azoteq_iqs7211e_pinch.h"
+#include "azoteq_iqs7211e_transform.h"
+#include "azoteq_iqs7211e_ptp.h"
+#include "azoteq_iqs7211e_diag.h"
+#include "azoteq_iqs7211e_noise.h"
+#include "azoteq_iqs7211e_log.h"
+#include "azoteq_iqs7211e_units.h"
+#include "azoteq_iqs7211e_power.h"
 #include "IQS7211_init.h"
-#include "gpio.h"
-#include "timer.h"
 #include <stdlib.h>
 
-const pointing_device_driver_t azoteq_iqs7211e_pointing_device_driver = {
-    .init       = azoteq_iqs7211e_init,
-    .get_report = azoteq_iqs7211e_get_report,
-    .set_cpi    = azoteq_iqs7211e_set_cpi,
-    .get_cpi    = azoteq_iqs7211e_get_cpi,
-};
-
 static uint16_t     azoteq_iqs7211e_product_number = 0;
 static i2c_status_t azoteq_iqs7211e_init_status    = I2C_STATUS_ERROR;
 static bool         azoteq_iqs7211e_use_ready_pin  = false;
 
+static uint16_t     azoteq_iqs7211e_frame_interval_x16 = 0;
+
+static azoteq_iqs7211e_frame_stats_t azoteq_iqs7211e_frame_stats = {0};
+static azoteq_iqs7211e_tracker_t     azoteq_iqs7211e_tracker     = {0};
+static azoteq_iqs7211e_transform_residue_t azoteq_iqs7211e_pointer_residue      = {0};
+static azoteq_iqs7211e_transform_residue_t azoteq_iqs7211e_scroll_residue       = {0};
+static int16_t                             azoteq_iqs7211e_pointer_remainder[2] = {0};
+static int16_t                             azoteq_iqs7211e_scroll_remainder[2]  = {0};
+#ifdef AZOTEQ_IQS7211E_PREDICT_ENABLE
+static azoteq_iqs7211e_predictor_t azoteq_iqs7211e_predictor;
+#endif
+#ifdef AZOTEQ_IQS7211E_RIM_SCROLL_ENABLE
+static azoteq_iqs7211e_rim_t azoteq_iqs7211e_rim;
+static bool                  azoteq_iqs7211e_rim_active = false;
+#endif
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+static azoteq_iqs7211e_pinch_t azoteq_iqs7211e_pinch = {0};
+#endif
+
+static uint8_t  azoteq_iqs7211e_last_info_flags = 0;
+static bool     azoteq_iqs7211e_reati_pending  = false;
+static bool     azoteq_iqs7211e_reati_settling = false;
+static bool     azoteq_iqs7211e_touching       = false;
+static uint32_t azoteq_iqs7211e_reati_time     = 0;
+static uint32_t azoteq_iqs7211e_touch_time     = 0;
+#ifdef AZOTEQ_IQS7211E_AUTO_REATI_ENABLE
+static bool     azoteq_iqs7211e_reati_on_lift  = false;
+static uint32_t azoteq_iqs7211e_still_time     = 0;
+#endif
+
+#ifdef AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+#ifdef AZOTEQ_IQS7211E_BUS_BENCHMARK_AT_INIT
+#error "AZOTEQ_IQS7211E_BUS_BENCHMARK_AT_INIT needs a platform that sets the bus clock"
+#endif
+#else
+static azoteq_iqs7211e_bus_profile_t azoteq_iqs7211e_bus_profile     = AZOTEQ_IQS7211E_BUS_PROFILE;
+static uint8_t                       azoteq_iqs7211e_bus_error_count = 0;
+#endif
+
+static const uint32_t azoteq_iqs7211e_bus_clock[AZOTEQ_IQS7211E_BUS_PROFILE_COUNT] = {
+    [AZOTEQ_IQS7211E_BUS_STANDARD]  = 100000,
+    [AZOTEQ_IQS7211E_BUS_FAST]      = 400000,
+    [AZOTEQ_IQS7211E_BUS_FAST_PLUS] = 1000000,
+};
+
 bool azoteq_iqs7211e_is_ready(void) {
     if (azoteq_iqs7211e_use_ready_pin) {
-        // RDY pin is active LOW
-        return !readPin(AZOTEQ_IQS7211E_RDY_PIN);
+        return azoteq_iqs7211e_rdy_asserted();
     }
     return true; // If no RDY pin configured, assume always ready
 }
@@ -50,13 +93,148 @@ void azoteq_iqs7211e_wait_for_ready(uint16_t timeout_ms) {
 
     uint16_t elapsed = 0;
     while (!azoteq_iqs7211e_is_ready() && elapsed < timeout_ms) {
-        wait_ms(1);
+        azoteq_iqs7211e_delay_ms(1);
         elapsed++;
     }
 
     if (elapsed >= timeout_ms) {
-        dprintf("IQS7211E: RDY timeout after %dms\n", timeout_ms);
+        AZOTEQ_IQS7211E_LOG(RDY_TIMEOUT, 0, timeout_ms);
+    }
+}
+
+#ifdef AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+azoteq_iqs7211e_bus_profile_t azoteq_iqs7211e_get_bus_profile(void) {
+    return AZOTEQ_IQS7211E_BUS_PROFILE;
+}
+
+// The board's clock is the only profile, so there is nothing to step down to
+static bool azoteq_iqs7211e_bus_probe(void) {
+    dprintf("IQS7211E: Bus clock %lu Hz\n", (unsigned long)azoteq_iqs7211e_bus_clock[AZOTEQ_IQS7211E_BUS_PROFILE]);
+    return azoteq_iqs7211e_get_product() == AZOTEQ_IQS7211E_PRODUCT_NUM;
+}
+#else
+bool azoteq_iqs7211e_set_bus_profile(azoteq_iqs7211e_bus_profile_t profile) {
+    if (profile >= AZOTEQ_IQS7211E_BUS_PROFILE_COUNT || !azoteq_iqs7211e_bus_set_clock(azoteq_iqs7211e_bus_clock[profile])) {
+        return false;
+    }
+
+    azoteq_iqs7211e_bus_profile     = profile;
+    azoteq_iqs7211e_bus_error_count = 0;
+    dprintf("IQS7211E: Bus clock %lu Hz\n", (unsigned long)azoteq_iqs7211e_bus_clock[profile]);
+    return true;
+}
+
+azoteq_iqs7211e_bus_profile_t azoteq_iqs7211e_get_bus_profile(void) {
+    return azoteq_iqs7211e_bus_profile;
+}
+
+// Select the fastest profile, up to the configured one, that reads back the product number
+static bool azoteq_iqs7211e_bus_probe(void) {
+    int8_t profile = AZOTEQ_IQS7211E_BUS_PROFILE;
+
+    while (profile >= AZOTEQ_IQS7211E_BUS_STANDARD) {
+        if (azoteq_iqs7211e_set_bus_profile(profile) && azoteq_iqs7211e_get_product() == AZOTEQ_IQS7211E_PRODUCT_NUM) {
+            return true;
+        }
+        profile--;
+    }
+
+    return false;
+}
+
+// Track bus transfers and step down one profile on a run of NACKs or timeouts
+static void azoteq_iqs7211e_bus_track(i2c_status_t status) {
+    if (status == I2C_STATUS_SUCCESS) {
+        azoteq_iqs7211e_bus_error_count = 0;
+        return;
+    }
+
+    if (++azoteq_iqs7211e_bus_error_count >= AZOTEQ_IQS7211E_BUS_FALLBACK_ERRORS && azoteq_iqs7211e_bus_profile > AZOTEQ_IQS7211E_BUS_STANDARD && azoteq_iqs7211e_set_bus_profile(azoteq_iqs7211e_bus_profile - 1)) {
+        AZOTEQ_IQS7211E_LOG(BUS_FALLBACK, azoteq_iqs7211e_bus_profile, 0);
+    }
+}
+
+// Times frame reads in streaming mode, one per comms window; needs a clock_us
+// that actually counts microseconds
+void azoteq_iqs7211e_bus_benchmark(uint32_t frame_read_us[AZOTEQ_IQS7211E_BUS_PROFILE_COUNT]) {
+    for (uint8_t profile = 0; profile < AZOTEQ_IQS7211E_BUS_PROFILE_COUNT; profile++) {
+        frame_read_us[profile] = 0;
+    }
+
+#if AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION > 1
+    dprintf("IQS7211E: Bench needs a microsecond clock\n");
+#else
+    azoteq_iqs7211e_bus_profile_t selected = azoteq_iqs7211e_bus_profile;
+    azoteq_iqs7211e_base_data_t   base_data;
+
+    for (uint8_t profile = 0; profile < AZOTEQ_IQS7211E_BUS_PROFILE_COUNT; profile++) {
+        bool found = azoteq_iqs7211e_set_bus_profile(profile) && azoteq_iqs7211e_get_product() == AZOTEQ_IQS7211E_PRODUCT_NUM;
+        azoteq_iqs7211e_end_session();
+        if (!found) {
+            dprintf("IQS7211E: Bench %lu Hz unsupported\n", (unsigned long)azoteq_iqs7211e_bus_clock[profile]);
+            continue;
+        }
+
+        uint32_t total = 0;
+        uint16_t frames;
+        for (frames = 0; frames < AZOTEQ_IQS7211E_BENCHMARK_FRAMES; frames++) {
+            azoteq_iqs7211e_wait_for_ready(50);
+            uint32_t     start   = azoteq_iqs7211e_clock_us();
+            i2c_status_t status  = azoteq_iqs7211e_bus_read(IQS7211E_MM_RELATIVE_X, (uint8_t *)&base_data, sizeof(base_data));
+            uint32_t     elapsed = azoteq_iqs7211e_clock_us() - start;
+            azoteq_iqs7211e_end_session();
+            if (status != I2C_STATUS_SUCCESS) {
+                break;
+            }
+            total += elapsed;
+        }
+
+        if (frames > 0) {
+            frame_read_us[profile] = total / frames;
+        }
+        dprintf("IQS7211E: Bench %lu Hz, %u frames, %lu us/frame\n", (unsigned long)azoteq_iqs7211e_bus_clock[profile], frames, (unsigned long)frame_read_us[profile]);
     }
+
+    azoteq_iqs7211e_set_bus_profile(selected);
+#endif
+}
+#endif
+
+// Open a communication window: wait for RDY, which the sensor asserts once per conversion
+bool azoteq_iqs7211e_begin_session(uint16_t timeout_ms) {
+    static uint32_t last_frame_time = 0;
+
+    if (azoteq_iqs7211e_use_ready_pin) {
+        if (timeout_ms > 0) {
+            azoteq_iqs7211e_wait_for_ready(timeout_ms);
+        }
+        if (!azoteq_iqs7211e_is_ready()) {
+            return false;
+        }
+    }
+
+    // Track the average interval between windows, in 1/16 ms
+    uint32_t now      = azoteq_iqs7211e_clock_ms();
+    uint32_t interval = now - last_frame_time;
+    last_frame_time   = now;
+    if (interval < 1000) {
+        azoteq_iqs7211e_frame_interval_x16 += (int32_t)((interval << 4) - azoteq_iqs7211e_frame_interval_x16) >> 3;
+    }
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+    azoteq_iqs7211e_power_count_wake();
+#endif
+
+    return true;
+}
+
+// Close the communication window right away instead of waiting for the sensor's I2C timeout
+i2c_status_t azoteq_iqs7211e_end_session(void) {
+    uint8_t data = 0x00;
+    return azoteq_iqs7211e_bus_write(IQS7211E_MM_END_SESSION, &data, 1);
+}
+
+uint16_t azoteq_iqs7211e_get_frame_interval(void) {
+    return azoteq_iqs7211e_frame_interval_x16 >> 4;
 }
 
 i2c_status_t azoteq_iqs7211e_get_base_data(azoteq_iqs7211e_base_data_t *base_data) {
@@ -64,46 +242,28 @@ i2c_status_t azoteq_iqs7211e_get_base_data(azoteq_iqs7211e_base_data_t *base_dat
     azoteq_iqs7211e_wait_for_ready(50);
 
     if (!azoteq_iqs7211e_is_ready()) {
-        dprintf("IQS7211E: Device not ready for data read\n");
+        AZOTEQ_IQS7211E_LOG(FRAME_NOT_READY, 0, 0);
         return I2C_STATUS_ERROR;
     }
 
-    uint8_t      transferBytes[18];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_RELATIVE_X, transferBytes, 18, AZOTEQ_IQS7211E_TIMEOUT_MS);
-
-    if (status == I2C_STATUS_SUCCESS) {
-        base_data->relative_x.l  = transferBytes[0];
-        base_data->relative_x.h  = transferBytes[1];
-        base_data->relative_y.l  = transferBytes[2];
-        base_data->relative_y.h  = transferBytes[3];
-        base_data->gesture_x.l   = transferBytes[4];
-        base_data->gesture_x.h   = transferBytes[5];
-        base_data->gesture_y.l   = transferBytes[6];
-        base_data->gesture_y.h   = transferBytes[7];
-        base_data->gestures[0]   = transferBytes[8];
-        base_data->gestures[1]   = transferBytes[9];
-        base_data->info_flags[0] = transferBytes[10];
-        base_data->info_flags[1] = transferBytes[11];
-        base_data->finger_1_x.l  = transferBytes[12];
-        base_data->finger_1_x.h  = transferBytes[13];
-        base_data->finger_1_y.l  = transferBytes[14];
-        base_data->finger_1_y.h  = transferBytes[15];
-        base_data->finger_2_x.l  = transferBytes[16];
-        base_data->finger_2_x.h  = transferBytes[17];
-    }
-
+    // The burst lands directly in the register layout. Only bus failures
+    // count towards the profile fallback, not a missing RDY.
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_RELATIVE_X, (uint8_t *)base_data, sizeof(*base_data));
+#ifndef AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+    azoteq_iqs7211e_bus_track(status);
+#endif
     return status;
 }
 
 i2c_status_t azoteq_iqs7211e_reset_suspend(bool reset, bool suspend) {
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         if (reset) {
             transferBytes[1] |= (1 << IQS7211E_SW_RESET_BIT);
         }
-        status = i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+        status = azoteq_iqs7211e_bus_write(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
     }
 
     return status;
@@ -111,7 +271,7 @@ i2c_status_t azoteq_iqs7211e_reset_suspend(bool reset, bool suspend) {
 
 i2c_status_t azoteq_iqs7211e_set_event_mode(bool enabled) {
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_CONFIG_SETTINGS, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_CONFIG_SETTINGS, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         if (enabled) {
@@ -119,7 +279,7 @@ i2c_status_t azoteq_iqs7211e_set_event_mode(bool enabled) {
         } else {
             transferBytes[1] &= ~(1 << IQS7211E_EVENT_MODE_BIT);
         }
-        status = i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_CONFIG_SETTINGS, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+        status = azoteq_iqs7211e_bus_write(IQS7211E_MM_CONFIG_SETTINGS, transferBytes, 2);
     }
 
     return status;
@@ -128,12 +288,12 @@ i2c_status_t azoteq_iqs7211e_set_event_mode(bool enabled) {
 i2c_status_t azoteq_iqs7211e_acknowledge_reset(void) {
     azoteq_iqs7211e_wait_for_ready(50);
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         azoteq_iqs7211e_wait_for_ready(50);
         transferBytes[0] |= (1 << IQS7211E_ACK_RESET_BIT);
-        status = i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+        status = azoteq_iqs7211e_bus_write(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
         dprintf("IQS7211E: Acknowledged reset, status %d\n", status);
     }
 
@@ -143,14 +303,14 @@ i2c_status_t azoteq_iqs7211e_acknowledge_reset(void) {
 i2c_status_t azoteq_iqs7211e_reati(void) {
     azoteq_iqs7211e_wait_for_ready(100);
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         azoteq_iqs7211e_wait_for_ready(100);
         transferBytes[0] |= (1 << IQS7211E_TP_RE_ATI_BIT);
-        status = i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
-        dprintf("IQS7211E: RE-ATI enabled, status %d %d %d\n", status, transferBytes[0], transferBytes[1]);
+        status = azoteq_iqs7211e_bus_write(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
     }
+    AZOTEQ_IQS7211E_LOG(REATI, status, 0);
 
     return status;
 }
@@ -165,290 +325,463 @@ uint16_t azoteq_iqs7211e_get_product(void) {
         return 0;
     }
 
-    uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_PROD_NUM, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    azoteq_iqs7211e_version_data_t version;
+    i2c_status_t                   status = azoteq_iqs7211e_bus_read(IQS7211E_MM_PROD_NUM, (uint8_t *)&version, sizeof(version));
 
     if (status == I2C_STATUS_SUCCESS) {
-        azoteq_iqs7211e_product_number = transferBytes[0] | (transferBytes[1] << 8);
+        azoteq_iqs7211e_product_number = azoteq_iqs7211e_le16(version.product_number);
+        dprintf("IQS7211E: Firmware %u.%u\n", azoteq_iqs7211e_le16(version.major_version), azoteq_iqs7211e_le16(version.minor_version));
     }
 
     dprintf("IQS7211E: Product number %u, %d\n", azoteq_iqs7211e_product_number, status);
     return azoteq_iqs7211e_product_number;
 }
 
-void azoteq_iqs7211e_set_cpi(uint16_t cpi) {}
+void azoteq_iqs7211e_get_frame_stats(azoteq_iqs7211e_frame_stats_t *stats) {
+    *stats = azoteq_iqs7211e_frame_stats;
+}
+
+void azoteq_iqs7211e_reset_frame_stats(void) {
+    azoteq_iqs7211e_frame_stats = (azoteq_iqs7211e_frame_stats_t){0};
+}
+
+// Schedule a re-ATI for the next idle period
+void azoteq_iqs7211e_request_reati(void) {
+    azoteq_iqs7211e_reati_pending = true;
+}
+
+// Counts ATI events, runs requested re-ATIs once the pad is idle and, when
+// enabled, re-calibrates on drift. Runs inside the frame's comms window;
+// returns true while the frame should be discarded.
+static bool azoteq_iqs7211e_ati_monitor(const azoteq_iqs7211e_base_data_t *base_data) {
+    uint8_t flags  = base_data->info_flags[0];
+    uint8_t rising = flags & ~azoteq_iqs7211e_last_info_flags;
+    azoteq_iqs7211e_last_info_flags = flags;
+
+    if (rising & ((1 << IQS7211E_RE_ATI_OCCURRED_BIT) | (1 << IQS7211E_ALP_RE_ATI_OCCURRED_BIT))) {
+        azoteq_iqs7211e_frame_stats.sensor_reati++;
+    }
+    if (rising & ((1 << IQS7211E_ATI_ERROR_BIT) | (1 << IQS7211E_ALP_ATI_ERROR_BIT))) {
+        azoteq_iqs7211e_frame_stats.ati_errors++;
+        AZOTEQ_IQS7211E_LOG(ATI_ERROR, flags, 0);
+#ifdef AZOTEQ_IQS7211E_AUTO_REATI_ENABLE
+        azoteq_iqs7211e_request_reati();
+#endif
+    }
+
+    uint32_t now = azoteq_iqs7211e_clock_ms();
+    bool     idle;
+
+    if (azoteq_iqs7211e_reati_settling) {
+        if (azoteq_iqs7211e_elapsed_ms(azoteq_iqs7211e_reati_time) < AZOTEQ_IQS7211E_REATI_SETTLE_MS) {
+            return true;
+        }
+        azoteq_iqs7211e_reati_settling = false;
+    }
+
+    azoteq_iqs7211e_touching = azoteq_iqs7211e_finger_count(base_data) > 0;
+
+    if (!azoteq_iqs7211e_touching) {
+        // Lift frame; in event mode it is the last frame before the pad goes
+        // silent, so ordinary requests wait for azoteq_iqs7211e_reati_idle_task
+        idle = now - azoteq_iqs7211e_touch_time >= AZOTEQ_IQS7211E_REATI_IDLE_MS;
+#ifdef AZOTEQ_IQS7211E_AUTO_REATI_ENABLE
+        azoteq_iqs7211e_still_time    = now;
+        idle                          = idle || azoteq_iqs7211e_reati_on_lift;
+        azoteq_iqs7211e_reati_on_lift = false;
+    } else if (base_data->info_flags[1] & (1 << IQS7211E_TP_MOVEMENT_BIT)) {
+        azoteq_iqs7211e_still_time = now;
+        azoteq_iqs7211e_touch_time = now;
+        idle                       = false;
+    } else if (now - azoteq_iqs7211e_still_time >= AZOTEQ_IQS7211E_REATI_STUCK_MS) {
+        // No finger rests that still for that long: the contact is most likely
+        // a drifted baseline. A re-ATI under a real finger would bake it into
+        // the baseline, so wait for the lift; a contact that never lifts is
+        // reseeded by the sensor itself once its idle-touch timeout runs out.
+        azoteq_iqs7211e_frame_stats.stuck_touches++;
+        AZOTEQ_IQS7211E_LOG(STUCK_TOUCH, 0, 0);
+        azoteq_iqs7211e_still_time    = now;
+        azoteq_iqs7211e_touch_time    = now;
+        azoteq_iqs7211e_reati_pending = true;
+        azoteq_iqs7211e_reati_on_lift = true;
+        idle                          = false;
+#endif
+    } else {
+        azoteq_iqs7211e_touch_time = now;
+        idle                       = false;
+    }
+
+    if (azoteq_iqs7211e_reati_pending && idle) {
+        // Only sets the command bit; the sensor runs ATI by itself while frames are discarded
+        if (azoteq_iqs7211e_reati() == I2C_STATUS_SUCCESS) {
+            azoteq_iqs7211e_frame_stats.driver_reati++;
+            azoteq_iqs7211e_reati_pending  = false;
+            azoteq_iqs7211e_reati_settling = true;
+            azoteq_iqs7211e_reati_time     = now;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Runs a pending re-ATI once the pad has been untouched for
+// AZOTEQ_IQS7211E_REATI_IDLE_MS. In event mode no frame arrives while the pad
+// is idle, so this is called between frames and forces its own window.
+static void azoteq_iqs7211e_reati_idle_task(void) {
+    if (!azoteq_iqs7211e_reati_pending || azoteq_iqs7211e_touching || azoteq_iqs7211e_elapsed_ms(azoteq_iqs7211e_touch_time) < AZOTEQ_IQS7211E_REATI_IDLE_MS) {
+        return;
+    }
+
+    i2c_status_t status = azoteq_iqs7211e_reati();
+    azoteq_iqs7211e_end_session();
+
+    if (status == I2C_STATUS_SUCCESS) {
+        azoteq_iqs7211e_frame_stats.driver_reati++;
+        azoteq_iqs7211e_reati_pending  = false;
+        azoteq_iqs7211e_reati_settling = true;
+        azoteq_iqs7211e_reati_time     = azoteq_iqs7211e_clock_ms();
+    } else {
+        // Retry after another idle period rather than on every scan
+        azoteq_iqs7211e_touch_time = azoteq_iqs7211e_clock_ms();
+    }
+}
+
+// Coordinates of the fingers that are down, in slot order; a lifted finger 1 leaves finger 2 in its slot
+static uint8_t azoteq_iqs7211e_present_fingers(const azoteq_iqs7211e_base_data_t *base_data, uint16_t *x, uint16_t *y) {
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < AZOTEQ_IQS7211E_MAX_CONTACTS; i++) {
+        if (azoteq_iqs7211e_finger_present(base_data, i)) {
+            x[count] = azoteq_iqs7211e_finger_x(base_data, i);
+            y[count] = azoteq_iqs7211e_finger_y(base_data, i);
+            count++;
+        }
+    }
+    return count;
+}
+
+#ifdef AZOTEQ_IQS7211E_NOISE_HOP_ENABLE
+// Switches the trackpad and ALP conversion frequencies on sustained noise. Runs inside the frame's comms window.
+static void azoteq_iqs7211e_noise_monitor(const azoteq_iqs7211e_base_data_t *base_data) {
+    uint16_t x[AZOTEQ_IQS7211E_MAX_CONTACTS], y[AZOTEQ_IQS7211E_MAX_CONTACTS];
+    uint8_t  finger_count = azoteq_iqs7211e_present_fingers(base_data, x, y);
+
+    if (!azoteq_iqs7211e_noise_update(finger_count, x[0], y[0])) {
+        return;
+    }
+
+    uint8_t frequency = azoteq_iqs7211e_noise_hop();
+    if (azoteq_iqs7211e_write_block(AZOTEQ_IQS7211E_BLOCK_HARDWARE) == I2C_STATUS_SUCCESS) {
+        azoteq_iqs7211e_frame_stats.frequency_hops++;
+        // Counts shift with the frequency; recalibrate once the pad is free
+        azoteq_iqs7211e_request_reati();
+    }
+    AZOTEQ_IQS7211E_LOG(FREQUENCY_HOP, frequency, azoteq_iqs7211e_noise_alp_frequency());
+}
+#endif
+
+void azoteq_iqs7211e_set_cpi(uint16_t cpi) {
+    if (cpi == 0) {
+        return;
+    }
+    azoteq_iqs7211e_units_update((X_RESOLUTION_1 << 8) | X_RESOLUTION_0, (Y_RESOLUTION_1 << 8) | Y_RESOLUTION_0, cpi);
+}
 
 uint16_t azoteq_iqs7211e_get_cpi(void) {
-    return 0;
+    return azoteq_iqs7211e_units.cpi;
+}
+
+static const uint8_t azoteq_iqs7211e_block_address[AZOTEQ_IQS7211E_BLOCK_COUNT] = {
+    [AZOTEQ_IQS7211E_BLOCK_ALP_COMPENSATION] = IQS7211E_MM_ALP_ATI_COMP_A,
+    [AZOTEQ_IQS7211E_BLOCK_ATI]              = IQS7211E_MM_TP_GLOBAL_MIRRORS,
+    [AZOTEQ_IQS7211E_BLOCK_REPORT_RATES]     = IQS7211E_MM_ACTIVE_MODE_RR,
+    [AZOTEQ_IQS7211E_BLOCK_SYSTEM_CONTROL]   = IQS7211E_MM_SYS_CONTROL,
+    [AZOTEQ_IQS7211E_BLOCK_ALP_SETUP]        = IQS7211E_MM_ALP_SETUP,
+    [AZOTEQ_IQS7211E_BLOCK_THRESHOLDS]       = IQS7211E_MM_TP_TOUCH_SET_CLEAR_THR,
+    [AZOTEQ_IQS7211E_BLOCK_FILTER_BETAS]     = IQS7211E_MM_LP1_FILTERS,
+    [AZOTEQ_IQS7211E_BLOCK_HARDWARE]         = IQS7211E_MM_TP_CONV_FREQ,
+    [AZOTEQ_IQS7211E_BLOCK_TP_SETTINGS]      = IQS7211E_MM_TP_RX_SETTINGS,
+    [AZOTEQ_IQS7211E_BLOCK_VERSION]          = IQS7211E_MM_SETTINGS_VERSION,
+    [AZOTEQ_IQS7211E_BLOCK_GESTURES]         = IQS7211E_MM_GESTURE_ENABLE,
+    [AZOTEQ_IQS7211E_BLOCK_RX_TX_MAP]        = IQS7211E_MM_RX_TX_MAPPING_0_1,
+    [AZOTEQ_IQS7211E_BLOCK_CYCLES_0_9]       = IQS7211E_MM_PROXA_CYCLE0,
+    [AZOTEQ_IQS7211E_BLOCK_CYCLES_10_19]     = IQS7211E_MM_PROXA_CYCLE10,
+    [AZOTEQ_IQS7211E_BLOCK_CYCLE_20]         = IQS7211E_MM_PROXA_CYCLE20,
+};
+
+static const char *const azoteq_iqs7211e_block_name[AZOTEQ_IQS7211E_BLOCK_COUNT] = {
+    [AZOTEQ_IQS7211E_BLOCK_ALP_COMPENSATION] = "ALP Compensation",
+    [AZOTEQ_IQS7211E_BLOCK_ATI]              = "ATI Settings",
+    [AZOTEQ_IQS7211E_BLOCK_REPORT_RATES]     = "Report rates and timings",
+    [AZOTEQ_IQS7211E_BLOCK_SYSTEM_CONTROL]   = "System control settings",
+    [AZOTEQ_IQS7211E_BLOCK_ALP_SETUP]        = "ALP Settings",
+    [AZOTEQ_IQS7211E_BLOCK_THRESHOLDS]       = "Threshold settings",
+    [AZOTEQ_IQS7211E_BLOCK_FILTER_BETAS]     = "Filter Betas",
+    [AZOTEQ_IQS7211E_BLOCK_HARDWARE]         = "Hardware settings",
+    [AZOTEQ_IQS7211E_BLOCK_TP_SETTINGS]      = "TP Settings",
+    [AZOTEQ_IQS7211E_BLOCK_VERSION]          = "Version numbers",
+    [AZOTEQ_IQS7211E_BLOCK_GESTURES]         = "Gesture Settings",
+    [AZOTEQ_IQS7211E_BLOCK_RX_TX_MAP]        = "Rx Tx Map Settings",
+    [AZOTEQ_IQS7211E_BLOCK_CYCLES_0_9]       = "Cycle 0 - 9 Settings",
+    [AZOTEQ_IQS7211E_BLOCK_CYCLES_10_19]     = "Cycle 10 - 19 Settings",
+    [AZOTEQ_IQS7211E_BLOCK_CYCLE_20]         = "Cycle 20 Settings",
+};
+
+// Fill transferBytes with the register image of one block, return its length
+static uint8_t azoteq_iqs7211e_fill_block(azoteq_iqs7211e_block_t block, uint8_t *transferBytes) {
+    switch (block) {
+        case AZOTEQ_IQS7211E_BLOCK_ALP_COMPENSATION: // ALP Compensation (0x1F - 0x20)
+            transferBytes[0] = ALP_COMPENSATION_A_0;
+            transferBytes[1] = ALP_COMPENSATION_A_1;
+            transferBytes[2] = ALP_COMPENSATION_B_0;
+            transferBytes[3] = ALP_COMPENSATION_B_1;
+            return 4;
+        case AZOTEQ_IQS7211E_BLOCK_ATI: // ATI Settings (0x21 - 0x27)
+            transferBytes[0]  = TP_ATI_MULTIPLIERS_DIVIDERS_0;
+            transferBytes[1]  = TP_ATI_MULTIPLIERS_DIVIDERS_1;
+            transferBytes[2]  = TP_COMPENSATION_DIV;
+            transferBytes[3]  = TP_REF_DRIFT_LIMIT;
+            transferBytes[4]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.tp_ati_target);
+            transferBytes[5]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.tp_ati_target);
+            transferBytes[6]  = TP_MIN_COUNT_REATI_0;
+            transferBytes[7]  = TP_MIN_COUNT_REATI_1;
+            transferBytes[8]  = ALP_ATI_MULTIPLIERS_DIVIDERS_0;
+            transferBytes[9]  = ALP_ATI_MULTIPLIERS_DIVIDERS_1;
+            transferBytes[10] = ALP_COMPENSATION_DIV;
+            transferBytes[11] = ALP_LTA_DRIFT_LIMIT;
+            transferBytes[12] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.alp_ati_target);
+            transferBytes[13] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.alp_ati_target);
+            return 14;
+        case AZOTEQ_IQS7211E_BLOCK_REPORT_RATES: // Report rates and timings (0x28 - 0x32)
+            transferBytes[0]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.active_mode_report_rate);
+            transferBytes[1]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.active_mode_report_rate);
+            transferBytes[2]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.idle_touch_mode_report_rate);
+            transferBytes[3]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.idle_touch_mode_report_rate);
+            transferBytes[4]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.idle_mode_report_rate);
+            transferBytes[5]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.idle_mode_report_rate);
+            transferBytes[6]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.lp1_mode_report_rate);
+            transferBytes[7]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.lp1_mode_report_rate);
+            transferBytes[8]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.lp2_mode_report_rate);
+            transferBytes[9]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.lp2_mode_report_rate);
+            transferBytes[10] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.active_mode_timeout);
+            transferBytes[11] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.active_mode_timeout);
+            transferBytes[12] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.idle_touch_mode_timeout);
+            transferBytes[13] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.idle_touch_mode_timeout);
+            transferBytes[14] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.idle_mode_timeout);
+            transferBytes[15] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.idle_mode_timeout);
+            transferBytes[16] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.lp1_mode_timeout);
+            transferBytes[17] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.lp1_mode_timeout);
+            transferBytes[18] = REATI_RETRY_TIME;
+            transferBytes[19] = REF_UPDATE_TIME;
+            transferBytes[20] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.i2c_timeout);
+            transferBytes[21] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.i2c_timeout);
+            return 22;
+        case AZOTEQ_IQS7211E_BLOCK_SYSTEM_CONTROL: // System control settings (0x33 - 0x35)
+            transferBytes[0] = SYSTEM_CONTROL_0;
+            transferBytes[1] = SYSTEM_CONTROL_1;
+            transferBytes[2] = CONFIG_SETTINGS0;
+            transferBytes[3] = CONFIG_SETTINGS1 | (1 << IQS7211E_COMMS_END_CMD_BIT); // sessions are closed explicitly
+            transferBytes[4] = OTHER_SETTINGS_0;
+            transferBytes[5] = OTHER_SETTINGS_1;
+            return 6;
+        case AZOTEQ_IQS7211E_BLOCK_ALP_SETUP: // ALP Settings (0x36 - 0x37)
+            transferBytes[0] = ALP_SETUP_0;
+            transferBytes[1] = ALP_SETUP_1;
+            transferBytes[2] = ALP_TX_ENABLE_0;
+            transferBytes[3] = ALP_TX_ENABLE_1;
+            return 4;
+        case AZOTEQ_IQS7211E_BLOCK_THRESHOLDS: // Threshold settings (0x38 - 0x3A)
+            transferBytes[0] = azoteq_iqs7211e_tunables.tp_touch_set_threshold;
+            transferBytes[1] = azoteq_iqs7211e_tunables.tp_touch_clear_threshold;
+            transferBytes[2] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.alp_threshold);
+            transferBytes[3] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.alp_threshold);
+            transferBytes[4] = azoteq_iqs7211e_tunables.alp_set_debounce;
+            transferBytes[5] = azoteq_iqs7211e_tunables.alp_clear_debounce;
+            return 6;
+        case AZOTEQ_IQS7211E_BLOCK_FILTER_BETAS: // Filter Betas (0x3B - 0x3C)
+            transferBytes[0] = azoteq_iqs7211e_tunables.alp_count_beta_lp1;
+            transferBytes[1] = azoteq_iqs7211e_tunables.alp_lta_beta_lp1;
+            transferBytes[2] = azoteq_iqs7211e_tunables.alp_count_beta_lp2;
+            transferBytes[3] = azoteq_iqs7211e_tunables.alp_lta_beta_lp2;
+            return 4;
+        case AZOTEQ_IQS7211E_BLOCK_HARDWARE: // Hardware settings (0x3D - 0x40)
+            transferBytes[0] = TP_CONVERSION_FREQUENCY_UP_PASS_LENGTH;
+#ifdef AZOTEQ_IQS7211E_NOISE_HOP_ENABLE
+            transferBytes[1] = azoteq_iqs7211e_noise_frequency();
+#else
+            transferBytes[1] = TP_CONVERSION_FREQUENCY_FRACTION_VALUE;
+#endif
+            transferBytes[2] = ALP_CONVERSION_FREQUENCY_UP_PASS_LENGTH;
+#ifdef AZOTEQ_IQS7211E_NOISE_HOP_ENABLE
+            transferBytes[3] = azoteq_iqs7211e_noise_alp_frequency();
+#else
+            transferBytes[3] = ALP_CONVERSION_FREQUENCY_FRACTION_VALUE;
+#endif
+            transferBytes[4] = TRACKPAD_HARDWARE_SETTINGS_0;
+            transferBytes[5] = TRACKPAD_HARDWARE_SETTINGS_1;
+            transferBytes[6] = ALP_HARDWARE_SETTINGS_0;
+            transferBytes[7] = ALP_HARDWARE_SETTINGS_1;
+            return 8;
+        case AZOTEQ_IQS7211E_BLOCK_TP_SETTINGS: // TP Settings (0x41 - 0x49)
+            transferBytes[0]  = TRACKPAD_SETTINGS_0_0;
+            transferBytes[1]  = TRACKPAD_SETTINGS_0_1;
+            transferBytes[2]  = TRACKPAD_SETTINGS_1_0;
+            transferBytes[3]  = TRACKPAD_SETTINGS_1_1;
+            transferBytes[4]  = X_RESOLUTION_0;
+            transferBytes[5]  = X_RESOLUTION_1;
+            transferBytes[6]  = Y_RESOLUTION_0;
+            transferBytes[7]  = Y_RESOLUTION_1;
+            transferBytes[8]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.xy_filter_bottom_speed);
+            transferBytes[9]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.xy_filter_bottom_speed);
+            transferBytes[10] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.xy_filter_top_speed);
+            transferBytes[11] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.xy_filter_top_speed);
+            transferBytes[12] = azoteq_iqs7211e_tunables.xy_filter_bottom_beta;
+            transferBytes[13] = azoteq_iqs7211e_tunables.xy_static_filter_beta;
+            transferBytes[14] = azoteq_iqs7211e_tunables.stationary_touch_threshold;
+            transferBytes[15] = FINGER_SPLIT_FACTOR;
+            transferBytes[16] = X_TRIM_VALUE;
+            transferBytes[17] = Y_TRIM_VALUE;
+            return 18;
+        case AZOTEQ_IQS7211E_BLOCK_VERSION: // Version numbers (0x4A)
+            transferBytes[0] = MINOR_VERSION;
+            transferBytes[1] = MAJOR_VERSION;
+            return 2;
+        case AZOTEQ_IQS7211E_BLOCK_GESTURES: // Gesture Settings (0x4B - 0x55)
+            transferBytes[0]  = GESTURE_ENABLE_0;
+            transferBytes[1]  = GESTURE_ENABLE_1;
+            transferBytes[2]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.tap_touch_time);
+            transferBytes[3]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.tap_touch_time);
+            transferBytes[4]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.tap_wait_time);
+            transferBytes[5]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.tap_wait_time);
+            transferBytes[6]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.tap_distance);
+            transferBytes[7]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.tap_distance);
+            transferBytes[8]  = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.hold_time);
+            transferBytes[9]  = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.hold_time);
+            transferBytes[10] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.swipe_time);
+            transferBytes[11] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.swipe_time);
+            transferBytes[12] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.swipe_x_distance);
+            transferBytes[13] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.swipe_x_distance);
+            transferBytes[14] = AZOTEQ_IQS7211E_LOW_BYTE(azoteq_iqs7211e_tunables.swipe_y_distance);
+            transferBytes[15] = AZOTEQ_IQS7211E_HIGH_BYTE(azoteq_iqs7211e_tunables.swipe_y_distance);
+            transferBytes[16] = SWIPE_X_CONS_DIST_0;
+            transferBytes[17] = SWIPE_X_CONS_DIST_1;
+            transferBytes[18] = SWIPE_Y_CONS_DIST_0;
+            transferBytes[19] = SWIPE_Y_CONS_DIST_1;
+            transferBytes[20] = SWIPE_ANGLE;
+            transferBytes[21] = azoteq_iqs7211e_tunables.palm_threshold;
+            return 22;
+        case AZOTEQ_IQS7211E_BLOCK_RX_TX_MAP: // Rx Tx Map Settings (0x56 - 0x5C)
+            transferBytes[0]  = RX_TX_MAP_0;
+            transferBytes[1]  = RX_TX_MAP_1;
+            transferBytes[2]  = RX_TX_MAP_2;
+            transferBytes[3]  = RX_TX_MAP_3;
+            transferBytes[4]  = RX_TX_MAP_4;
+            transferBytes[5]  = RX_TX_MAP_5;
+            transferBytes[6]  = RX_TX_MAP_6;
+            transferBytes[7]  = RX_TX_MAP_7;
+            transferBytes[8]  = RX_TX_MAP_8;
+            transferBytes[9]  = RX_TX_MAP_9;
+            transferBytes[10] = RX_TX_MAP_10;
+            transferBytes[11] = RX_TX_MAP_11;
+            transferBytes[12] = RX_TX_MAP_12;
+            transferBytes[13] = RX_TX_MAP_FILLER;
+            return 14;
+        case AZOTEQ_IQS7211E_BLOCK_CYCLES_0_9: // Cycle 0 - 9 Settings (0x5D - 0x6B)
+            transferBytes[0]  = PLACEHOLDER_0;
+            transferBytes[1]  = CH_1_CYCLE_0;
+            transferBytes[2]  = CH_2_CYCLE_0;
+            transferBytes[3]  = PLACEHOLDER_1;
+            transferBytes[4]  = CH_1_CYCLE_1;
+            transferBytes[5]  = CH_2_CYCLE_1;
+            transferBytes[6]  = PLACEHOLDER_2;
+            transferBytes[7]  = CH_1_CYCLE_2;
+            transferBytes[8]  = CH_2_CYCLE_2;
+            transferBytes[9]  = PLACEHOLDER_3;
+            transferBytes[10] = CH_1_CYCLE_3;
+            transferBytes[11] = CH_2_CYCLE_3;
+            transferBytes[12] = PLACEHOLDER_4;
+            transferBytes[13] = CH_1_CYCLE_4;
+            transferBytes[14] = CH_2_CYCLE_4;
+            transferBytes[15] = PLACEHOLDER_5;
+            transferBytes[16] = CH_1_CYCLE_5;
+            transferBytes[17] = CH_2_CYCLE_5;
+            transferBytes[18] = PLACEHOLDER_6;
+            transferBytes[19] = CH_1_CYCLE_6;
+            transferBytes[20] = CH_2_CYCLE_6;
+            transferBytes[21] = PLACEHOLDER_7;
+            transferBytes[22] = CH_1_CYCLE_7;
+            transferBytes[23] = CH_2_CYCLE_7;
+            transferBytes[24] = PLACEHOLDER_8;
+            transferBytes[25] = CH_1_CYCLE_8;
+            transferBytes[26] = CH_2_CYCLE_8;
+            transferBytes[27] = PLACEHOLDER_9;
+            transferBytes[28] = CH_1_CYCLE_9;
+            transferBytes[29] = CH_2_CYCLE_9;
+            return 30;
+        case AZOTEQ_IQS7211E_BLOCK_CYCLES_10_19: // Cycle 10 - 19 Settings (0x6C - 0x7A)
+            transferBytes[0]  = PLACEHOLDER_10;
+            transferBytes[1]  = CH_1_CYCLE_10;
+            transferBytes[2]  = CH_2_CYCLE_10;
+            transferBytes[3]  = PLACEHOLDER_11;
+            transferBytes[4]  = CH_1_CYCLE_11;
+            transferBytes[5]  = CH_2_CYCLE_11;
+            transferBytes[6]  = PLACEHOLDER_12;
+            transferBytes[7]  = CH_1_CYCLE_12;
+            transferBytes[8]  = CH_2_CYCLE_12;
+            transferBytes[9]  = PLACEHOLDER_13;
+            transferBytes[10] = CH_1_CYCLE_13;
+            transferBytes[11] = CH_2_CYCLE_13;
+            transferBytes[12] = PLACEHOLDER_14;
+            transferBytes[13] = CH_1_CYCLE_14;
+            transferBytes[14] = CH_2_CYCLE_14;
+            transferBytes[15] = PLACEHOLDER_15;
+            transferBytes[16] = CH_1_CYCLE_15;
+            transferBytes[17] = CH_2_CYCLE_15;
+            transferBytes[18] = PLACEHOLDER_16;
+            transferBytes[19] = CH_1_CYCLE_16;
+            transferBytes[20] = CH_2_CYCLE_16;
+            transferBytes[21] = PLACEHOLDER_17;
+            transferBytes[22] = CH_1_CYCLE_17;
+            transferBytes[23] = CH_2_CYCLE_17;
+            transferBytes[24] = PLACEHOLDER_18;
+            transferBytes[25] = CH_1_CYCLE_18;
+            transferBytes[26] = CH_2_CYCLE_18;
+            transferBytes[27] = PLACEHOLDER_19;
+            transferBytes[28] = CH_1_CYCLE_19;
+            transferBytes[29] = CH_2_CYCLE_19;
+            return 30;
+        case AZOTEQ_IQS7211E_BLOCK_CYCLE_20: // Cycle 20 Settings (0x7B - 0x7C)
+            transferBytes[0] = PLACEHOLDER_20;
+            transferBytes[1] = CH_1_CYCLE_20;
+            transferBytes[2] = CH_2_CYCLE_20;
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+i2c_status_t azoteq_iqs7211e_write_block(azoteq_iqs7211e_block_t block) {
+    uint8_t transferBytes[30];
+    uint8_t length = azoteq_iqs7211e_fill_block(block, transferBytes);
+
+    if (length == 0) {
+        return I2C_STATUS_ERROR;
+    }
+
+    azoteq_iqs7211e_wait_for_ready(100);
+    return azoteq_iqs7211e_bus_write(azoteq_iqs7211e_block_address[block], transferBytes, length);
 }
 
 i2c_status_t azoteq_iqs7211e_write_memory_map(void) {
-    uint8_t      transferBytes[30];
     i2c_status_t status = I2C_STATUS_SUCCESS;
 
     dprintf("IQS7211E: Writing memory map\n");
 
-    // 1. Write ALP Compensation (0x1F - 0x20)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = ALP_COMPENSATION_A_0;
-    transferBytes[1] = ALP_COMPENSATION_A_1;
-    transferBytes[2] = ALP_COMPENSATION_B_0;
-    transferBytes[3] = ALP_COMPENSATION_B_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_ALP_ATI_COMP_A, transferBytes, 4, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t1. Write ALP Compensation\n");
-
-    // 2. Write ATI Settings (0x21 - 0x27)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = TP_ATI_MULTIPLIERS_DIVIDERS_0;
-    transferBytes[1]  = TP_ATI_MULTIPLIERS_DIVIDERS_1;
-    transferBytes[2]  = TP_COMPENSATION_DIV;
-    transferBytes[3]  = TP_REF_DRIFT_LIMIT;
-    transferBytes[4]  = TP_ATI_TARGET_0;
-    transferBytes[5]  = TP_ATI_TARGET_1;
-    transferBytes[6]  = TP_MIN_COUNT_REATI_0;
-    transferBytes[7]  = TP_MIN_COUNT_REATI_1;
-    transferBytes[8]  = ALP_ATI_MULTIPLIERS_DIVIDERS_0;
-    transferBytes[9]  = ALP_ATI_MULTIPLIERS_DIVIDERS_1;
-    transferBytes[10] = ALP_COMPENSATION_DIV;
-    transferBytes[11] = ALP_LTA_DRIFT_LIMIT;
-    transferBytes[12] = ALP_ATI_TARGET_0;
-    transferBytes[13] = ALP_ATI_TARGET_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_TP_GLOBAL_MIRRORS, transferBytes, 14, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t2. Write ATI Settings\n");
-
-    // 3. Write Report rates and timings (0x28 - 0x32)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = ACTIVE_MODE_REPORT_RATE_0;
-    transferBytes[1]  = ACTIVE_MODE_REPORT_RATE_1;
-    transferBytes[2]  = IDLE_TOUCH_MODE_REPORT_RATE_0;
-    transferBytes[3]  = IDLE_TOUCH_MODE_REPORT_RATE_1;
-    transferBytes[4]  = IDLE_MODE_REPORT_RATE_0;
-    transferBytes[5]  = IDLE_MODE_REPORT_RATE_1;
-    transferBytes[6]  = LP1_MODE_REPORT_RATE_0;
-    transferBytes[7]  = LP1_MODE_REPORT_RATE_1;
-    transferBytes[8]  = LP2_MODE_REPORT_RATE_0;
-    transferBytes[9]  = LP2_MODE_REPORT_RATE_1;
-    transferBytes[10] = ACTIVE_MODE_TIMEOUT_0;
-    transferBytes[11] = ACTIVE_MODE_TIMEOUT_1;
-    transferBytes[12] = IDLE_TOUCH_MODE_TIMEOUT_0;
-    transferBytes[13] = IDLE_TOUCH_MODE_TIMEOUT_1;
-    transferBytes[14] = IDLE_MODE_TIMEOUT_0;
-    transferBytes[15] = IDLE_MODE_TIMEOUT_1;
-    transferBytes[16] = LP1_MODE_TIMEOUT_0;
-    transferBytes[17] = LP1_MODE_TIMEOUT_1;
-    transferBytes[18] = REATI_RETRY_TIME;
-    transferBytes[19] = REF_UPDATE_TIME;
-    transferBytes[20] = I2C_TIMEOUT_0;
-    transferBytes[21] = I2C_TIMEOUT_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_ACTIVE_MODE_RR, transferBytes, 22, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t3. Write Report rates and timings\n");
-
-    // 4. Write System control settings (0x33 - 0x35)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = SYSTEM_CONTROL_0;
-    transferBytes[1] = SYSTEM_CONTROL_1;
-    transferBytes[2] = CONFIG_SETTINGS0;
-    transferBytes[3] = CONFIG_SETTINGS1;
-    transferBytes[4] = OTHER_SETTINGS_0;
-    transferBytes[5] = OTHER_SETTINGS_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 6, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t4. Write System control settings\n");
-
-    // 5. Write ALP Settings (0x36 - 0x37)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = ALP_SETUP_0;
-    transferBytes[1] = ALP_SETUP_1;
-    transferBytes[2] = ALP_TX_ENABLE_0;
-    transferBytes[3] = ALP_TX_ENABLE_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_ALP_SETUP, transferBytes, 4, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t5. Write ALP Settings\n");
-
-    // 6. Write Threshold settings (0x38 - 0x3A)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = TRACKPAD_TOUCH_SET_THRESHOLD;
-    transferBytes[1] = TRACKPAD_TOUCH_CLEAR_THRESHOLD;
-    transferBytes[2] = ALP_THRESHOLD_0;
-    transferBytes[3] = ALP_THRESHOLD_1;
-    transferBytes[4] = ALP_SET_DEBOUNCE;
-    transferBytes[5] = ALP_CLEAR_DEBOUNCE;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_TP_TOUCH_SET_CLEAR_THR, transferBytes, 6, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t6. Write Threshold settings\n");
-
-    // 7. Write Filter Betas (0x3B - 0x3C)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = ALP_COUNT_BETA_LP1;
-    transferBytes[1] = ALP_LTA_BETA_LP1;
-    transferBytes[2] = ALP_COUNT_BETA_LP2;
-    transferBytes[3] = ALP_LTA_BETA_LP2;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_LP1_FILTERS, transferBytes, 4, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t7. Write Filter Betas\n");
-
-    // 8. Write Hardware settings (0x3D - 0x40)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = TP_CONVERSION_FREQUENCY_UP_PASS_LENGTH;
-    transferBytes[1] = TP_CONVERSION_FREQUENCY_FRACTION_VALUE;
-    transferBytes[2] = ALP_CONVERSION_FREQUENCY_UP_PASS_LENGTH;
-    transferBytes[3] = ALP_CONVERSION_FREQUENCY_FRACTION_VALUE;
-    transferBytes[4] = TRACKPAD_HARDWARE_SETTINGS_0;
-    transferBytes[5] = TRACKPAD_HARDWARE_SETTINGS_1;
-    transferBytes[6] = ALP_HARDWARE_SETTINGS_0;
-    transferBytes[7] = ALP_HARDWARE_SETTINGS_1;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_TP_CONV_FREQ, transferBytes, 8, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t8. Write Hardware settings\n");
-
-    // 9. Write TP Settings (0x41 - 0x49)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = TRACKPAD_SETTINGS_0_0;
-    transferBytes[1]  = TRACKPAD_SETTINGS_0_1;
-    transferBytes[2]  = TRACKPAD_SETTINGS_1_0;
-    transferBytes[3]  = TRACKPAD_SETTINGS_1_1;
-    transferBytes[4]  = X_RESOLUTION_0;
-    transferBytes[5]  = X_RESOLUTION_1;
-    transferBytes[6]  = Y_RESOLUTION_0;
-    transferBytes[7]  = Y_RESOLUTION_1;
-    transferBytes[8]  = XY_DYNAMIC_FILTER_BOTTOM_SPEED_0;
-    transferBytes[9]  = XY_DYNAMIC_FILTER_BOTTOM_SPEED_1;
-    transferBytes[10] = XY_DYNAMIC_FILTER_TOP_SPEED_0;
-    transferBytes[11] = XY_DYNAMIC_FILTER_TOP_SPEED_1;
-    transferBytes[12] = XY_DYNAMIC_FILTER_BOTTOM_BETA;
-    transferBytes[13] = XY_DYNAMIC_FILTER_STATIC_FILTER_BETA;
-    transferBytes[14] = STATIONARY_TOUCH_MOV_THRESHOLD;
-    transferBytes[15] = FINGER_SPLIT_FACTOR;
-    transferBytes[16] = X_TRIM_VALUE;
-    transferBytes[17] = Y_TRIM_VALUE;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_TP_RX_SETTINGS, transferBytes, 18, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t9. Write TP Settings\n");
-
-    // 10. Write Version numbers (0x4A)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = MINOR_VERSION;
-    transferBytes[1] = MAJOR_VERSION;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SETTINGS_VERSION, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t10. Write Version numbers\n");
-
-    // 11. Write Gesture Settings (0x4B - 0x55)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = GESTURE_ENABLE_0;
-    transferBytes[1]  = GESTURE_ENABLE_1;
-    transferBytes[2]  = TAP_TOUCH_TIME_0;
-    transferBytes[3]  = TAP_TOUCH_TIME_1;
-    transferBytes[4]  = TAP_WAIT_TIME_0;
-    transferBytes[5]  = TAP_WAIT_TIME_1;
-    transferBytes[6]  = TAP_DISTANCE_0;
-    transferBytes[7]  = TAP_DISTANCE_1;
-    transferBytes[8]  = HOLD_TIME_0;
-    transferBytes[9]  = HOLD_TIME_1;
-    transferBytes[10] = SWIPE_TIME_0;
-    transferBytes[11] = SWIPE_TIME_1;
-    transferBytes[12] = SWIPE_X_DISTANCE_0;
-    transferBytes[13] = SWIPE_X_DISTANCE_1;
-    transferBytes[14] = SWIPE_Y_DISTANCE_0;
-    transferBytes[15] = SWIPE_Y_DISTANCE_1;
-    transferBytes[16] = SWIPE_X_CONS_DIST_0;
-    transferBytes[17] = SWIPE_X_CONS_DIST_1;
-    transferBytes[18] = SWIPE_Y_CONS_DIST_0;
-    transferBytes[19] = SWIPE_Y_CONS_DIST_1;
-    transferBytes[20] = SWIPE_ANGLE;
-    transferBytes[21] = PALM_THRESHOLD;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_GESTURE_ENABLE, transferBytes, 22, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t11. Write Gesture Settings\n");
-
-    // 12. Write Rx Tx Map Settings (0x56 - 0x5C)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = RX_TX_MAP_0;
-    transferBytes[1]  = RX_TX_MAP_1;
-    transferBytes[2]  = RX_TX_MAP_2;
-    transferBytes[3]  = RX_TX_MAP_3;
-    transferBytes[4]  = RX_TX_MAP_4;
-    transferBytes[5]  = RX_TX_MAP_5;
-    transferBytes[6]  = RX_TX_MAP_6;
-    transferBytes[7]  = RX_TX_MAP_7;
-    transferBytes[8]  = RX_TX_MAP_8;
-    transferBytes[9]  = RX_TX_MAP_9;
-    transferBytes[10] = RX_TX_MAP_10;
-    transferBytes[11] = RX_TX_MAP_11;
-    transferBytes[12] = RX_TX_MAP_12;
-    transferBytes[13] = RX_TX_MAP_FILLER;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_RX_TX_MAPPING_0_1, transferBytes, 14, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t12. Write Rx Tx Map Settings\n");
-
-    // 13. Write Cycle 0 - 9 Settings (0x5D - 0x6B)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = PLACEHOLDER_0;
-    transferBytes[1]  = CH_1_CYCLE_0;
-    transferBytes[2]  = CH_2_CYCLE_0;
-    transferBytes[3]  = PLACEHOLDER_1;
-    transferBytes[4]  = CH_1_CYCLE_1;
-    transferBytes[5]  = CH_2_CYCLE_1;
-    transferBytes[6]  = PLACEHOLDER_2;
-    transferBytes[7]  = CH_1_CYCLE_2;
-    transferBytes[8]  = CH_2_CYCLE_2;
-    transferBytes[9]  = PLACEHOLDER_3;
-    transferBytes[10] = CH_1_CYCLE_3;
-    transferBytes[11] = CH_2_CYCLE_3;
-    transferBytes[12] = PLACEHOLDER_4;
-    transferBytes[13] = CH_1_CYCLE_4;
-    transferBytes[14] = CH_2_CYCLE_4;
-    transferBytes[15] = PLACEHOLDER_5;
-    transferBytes[16] = CH_1_CYCLE_5;
-    transferBytes[17] = CH_2_CYCLE_5;
-    transferBytes[18] = PLACEHOLDER_6;
-    transferBytes[19] = CH_1_CYCLE_6;
-    transferBytes[20] = CH_2_CYCLE_6;
-    transferBytes[21] = PLACEHOLDER_7;
-    transferBytes[22] = CH_1_CYCLE_7;
-    transferBytes[23] = CH_2_CYCLE_7;
-    transferBytes[24] = PLACEHOLDER_8;
-    transferBytes[25] = CH_1_CYCLE_8;
-    transferBytes[26] = CH_2_CYCLE_8;
-    transferBytes[27] = PLACEHOLDER_9;
-    transferBytes[28] = CH_1_CYCLE_9;
-    transferBytes[29] = CH_2_CYCLE_9;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_PROXA_CYCLE0, transferBytes, 30, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t13. Write Cycle 0 - 9 Settings\n");
-
-    // 14. Write Cycle 10 - 19 Settings (0x6C - 0x7A)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0]  = PLACEHOLDER_10;
-    transferBytes[1]  = CH_1_CYCLE_10;
-    transferBytes[2]  = CH_2_CYCLE_10;
-    transferBytes[3]  = PLACEHOLDER_11;
-    transferBytes[4]  = CH_1_CYCLE_11;
-    transferBytes[5]  = CH_2_CYCLE_11;
-    transferBytes[6]  = PLACEHOLDER_12;
-    transferBytes[7]  = CH_1_CYCLE_12;
-    transferBytes[8]  = CH_2_CYCLE_12;
-    transferBytes[9]  = PLACEHOLDER_13;
-    transferBytes[10] = CH_1_CYCLE_13;
-    transferBytes[11] = CH_2_CYCLE_13;
-    transferBytes[12] = PLACEHOLDER_14;
-    transferBytes[13] = CH_1_CYCLE_14;
-    transferBytes[14] = CH_2_CYCLE_14;
-    transferBytes[15] = PLACEHOLDER_15;
-    transferBytes[16] = CH_1_CYCLE_15;
-    transferBytes[17] = CH_2_CYCLE_15;
-    transferBytes[18] = PLACEHOLDER_16;
-    transferBytes[19] = CH_1_CYCLE_16;
-    transferBytes[20] = CH_2_CYCLE_16;
-    transferBytes[21] = PLACEHOLDER_17;
-    transferBytes[22] = CH_1_CYCLE_17;
-    transferBytes[23] = CH_2_CYCLE_17;
-    transferBytes[24] = PLACEHOLDER_18;
-    transferBytes[25] = CH_1_CYCLE_18;
-    transferBytes[26] = CH_2_CYCLE_18;
-    transferBytes[27] = PLACEHOLDER_19;
-    transferBytes[28] = CH_1_CYCLE_19;
-    transferBytes[29] = CH_2_CYCLE_19;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_PROXA_CYCLE10, transferBytes, 30, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t14. Write Cycle 10 - 19 Settings\n");
-
-    // 15. Write Cycle 20 Settings (0x7B - 0x7C)
-    azoteq_iqs7211e_wait_for_ready(100);
-    transferBytes[0] = PLACEHOLDER_20;
-    transferBytes[1] = CH_1_CYCLE_20;
-    transferBytes[2] = CH_2_CYCLE_20;
-    status |= i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_PROXA_CYCLE20, transferBytes, 3, AZOTEQ_IQS7211E_TIMEOUT_MS);
-    dprintf("\t15. Write Cycle 20 Settings\n");
+    for (uint8_t block = 0; block < AZOTEQ_IQS7211E_BLOCK_COUNT; block++) {
+        status |= azoteq_iqs7211e_write_block(block);
+        dprintf("\t%d. Write %s\n", block + 1, azoteq_iqs7211e_block_name[block]);
+    }
 
     dprintf("IQS7211E: Memory map write complete, status: %d\n", status);
     return status;
@@ -464,7 +797,7 @@ i2c_status_t azoteq_iqs7211e_check_reset(void) {
     }
 
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_INFO_FLAGS, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_INFO_FLAGS, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         return (transferBytes[0] & (1 << IQS7211E_SHOW_RESET_BIT)) ? I2C_STATUS_SUCCESS : I2C_STATUS_ERROR;
@@ -483,7 +816,7 @@ bool azoteq_iqs7211e_read_ati_active(void) {
     }
 
     uint8_t      transferBytes[2];
-    i2c_status_t status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, IQS7211E_MM_SYS_CONTROL, transferBytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS);
+    i2c_status_t status = azoteq_iqs7211e_bus_read(IQS7211E_MM_SYS_CONTROL, transferBytes, 2);
 
     if (status == I2C_STATUS_SUCCESS) {
         dprintf("IQS7211E: ATI active check, flags: 0x%02X\n", transferBytes[0]);
@@ -495,27 +828,33 @@ bool azoteq_iqs7211e_read_ati_active(void) {
 }
 
 void azoteq_iqs7211e_init(void) {
-    i2c_init();
+    azoteq_iqs7211e_bus_init();
 
     // Initialize RDY pin if configured
-    if (AZOTEQ_IQS7211E_RDY_PIN != NO_PIN) {
-        setPinInputHigh(AZOTEQ_IQS7211E_RDY_PIN);
-        azoteq_iqs7211e_use_ready_pin = true;
-        dprintf("IQS7211E: RDY pin configured on pin %d\n", AZOTEQ_IQS7211E_RDY_PIN);
+    azoteq_iqs7211e_use_ready_pin = azoteq_iqs7211e_rdy_init();
+    if (azoteq_iqs7211e_use_ready_pin) {
+        dprintf("IQS7211E: RDY pin configured\n");
     } else {
-        azoteq_iqs7211e_use_ready_pin = false;
         dprintf("IQS7211E: No RDY pin configured\n");
     }
 
-    debug_enable = true;
     dprintf("IQS7211E: Initialization started\n");
 
+    // Load persisted tunables before the memory map is written
+    azoteq_iqs7211e_tunables_init();
+    azoteq_iqs7211e_set_cpi(azoteq_iqs7211e_units.cpi);
+
     // Wait for device to be ready
     azoteq_iqs7211e_wait_for_ready(100);
 
+    // Pick the bus clock before any write goes out
+    if (!azoteq_iqs7211e_bus_probe()) {
+        dprintf("IQS7211E: No bus profile answered\n");
+    }
+
     // Software reset
     azoteq_iqs7211e_reset_suspend(true, false);
-    wait_ms(50);
+    azoteq_iqs7211e_delay_ms(50);
 
     // Wait for device to be ready after reset
     azoteq_iqs7211e_wait_for_ready(200);
@@ -528,34 +867,50 @@ void azoteq_iqs7211e_init(void) {
         if (azoteq_iqs7211e_check_reset() == I2C_STATUS_SUCCESS) {
             dprintf("IQS7211E: Reset event confirmed\n");
 
-            // Write all settings from init file
+            // Write all settings from init file. This enables the explicit
+            // end of comms, so from here on every window is closed by hand.
             azoteq_iqs7211e_init_status = azoteq_iqs7211e_write_memory_map();
+            azoteq_iqs7211e_end_session();
 
             if (azoteq_iqs7211e_init_status == I2C_STATUS_SUCCESS) {
                 // Acknowledge reset
                 azoteq_iqs7211e_init_status |= azoteq_iqs7211e_acknowledge_reset();
-                wait_ms(100);
+                azoteq_iqs7211e_end_session();
+                azoteq_iqs7211e_delay_ms(100);
 
                 // Run ATI
                 azoteq_iqs7211e_init_status |= azoteq_iqs7211e_reati();
+                azoteq_iqs7211e_end_session();
 
                 // Wait for ATI to complete
                 int ati_timeout = 30; // 1000 * 10ms = 10 second timeout
-                while (azoteq_iqs7211e_read_ati_active() && ati_timeout > 0) {
-                    wait_ms(5);
+                while (ati_timeout > 0) {
+                    bool ati_active = azoteq_iqs7211e_read_ati_active();
+                    azoteq_iqs7211e_end_session();
+                    if (!ati_active) {
+                        break;
+                    }
+                    azoteq_iqs7211e_delay_ms(5);
                     ati_timeout--;
                 }
 
                 if (ati_timeout >= 0) {
                     dprintf("IQS7211E: ATI completed\n");
 
+#ifdef AZOTEQ_IQS7211E_BUS_BENCHMARK_AT_INIT
+                    // Still streaming, so RDY paces the reads
+                    uint32_t frame_read_us[AZOTEQ_IQS7211E_BUS_PROFILE_COUNT];
+                    azoteq_iqs7211e_bus_benchmark(frame_read_us);
+#endif
+
                     // Wait for device to be ready before setting event mode
                     azoteq_iqs7211e_wait_for_ready(500);
 
                     // Set event mode
                     azoteq_iqs7211e_init_status |= azoteq_iqs7211e_set_event_mode(true);
+                    azoteq_iqs7211e_end_session();
 
-                    wait_ms(ACTIVE_MODE_REPORT_RATE_0 + 1);
+                    azoteq_iqs7211e_delay_ms(azoteq_iqs7211e_tunables.active_mode_report_rate + 1);
 
                     dprintf("IQS7211E: Init complete, status: %d\n", azoteq_iqs7211e_init_status);
                 } else {
@@ -570,14 +925,36 @@ void azoteq_iqs7211e_init(void) {
     } else {
         dprintf("IQS7211E: Device not found\n");
     }
+
+    if (azoteq_iqs7211e_init_status != I2C_STATUS_SUCCESS) {
+        AZOTEQ_IQS7211E_LOG(INIT_FAILED, azoteq_iqs7211e_init_status, azoteq_iqs7211e_product_number);
+    }
 }
 
-report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report) {
-    report_mouse_t  temp_report = {0};
-    static uint16_t previous_x = 0xffff, previous_y = 0xffff;
-    static uint16_t finger_2_prev_x = 0xffff, finger_2_prev_y = 0xffff;
-    static bool     previous_valid = false;
-    static bool     finger_2_prev_valid = false;
+#ifdef AZOTEQ_IQS7211E_PALM_REJECT_ENABLE
+// Palm gesture, more contacts than the sensor can track, or any contact too large
+static bool azoteq_iqs7211e_is_palm(const azoteq_iqs7211e_base_data_t *base_data) {
+    if (base_data->gestures[0] & (1 << IQS7211E_GESTURE_PALM_BIT)) {
+        return true;
+    }
+    if (base_data->info_flags[1] & (1 << IQS7211E_TOO_MANY_FINGERS_BIT)) {
+        return true;
+    }
+    for (uint8_t i = 0; i < AZOTEQ_IQS7211E_MAX_CONTACTS; i++) {
+        if (azoteq_iqs7211e_finger_present(base_data, i) && azoteq_iqs7211e_finger_area(base_data, i) > AZOTEQ_IQS7211E_PALM_AREA) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+// Read and decode one frame; motion stays zero when no frame was ready
+azoteq_iqs7211e_motion_t azoteq_iqs7211e_read_motion(void) {
+    azoteq_iqs7211e_motion_t motion = {0};
+    static uint16_t last_x = 0, last_y = 0;
+    static uint8_t  max_finger_count = 0;
+    static uint32_t last_frame_time = 0;
     static uint16_t tap_start_x = 0, tap_start_y = 0;
     static uint16_t touch_start_time = 0;
     static uint16_t last_tap_time = 0;
@@ -585,129 +962,254 @@ report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report) {
     static bool     double_tap_hold = false;
     static bool     is_clicking = false;
     static uint8_t  pending_click_release = 0;
+    static bool     touch_rejected = false;
+
+#if AZOTEQ_IQS7211E_LOG_LEVEL > AZOTEQ_IQS7211E_LOG_NONE
+    azoteq_iqs7211e_log_task();
+#endif
 
     if (azoteq_iqs7211e_init_status == I2C_STATUS_SUCCESS) {
         // Only read data if device is ready or if no RDY pin is configured
-        if (!azoteq_iqs7211e_use_ready_pin || azoteq_iqs7211e_is_ready()) {
-            azoteq_iqs7211e_base_data_t base_data = {0};
-            i2c_status_t                status    = azoteq_iqs7211e_get_base_data(&base_data);
+        if (azoteq_iqs7211e_begin_session(0)) {
+            // Batch all accesses for this frame inside one window
+            azoteq_iqs7211e_tunables_apply_pending();
+
+            uint32_t                    capture_us = azoteq_iqs7211e_clock_us();
+            azoteq_iqs7211e_base_data_t base_data  = {0};
+            i2c_status_t                status     = azoteq_iqs7211e_get_base_data(&base_data);
+            bool                        discard    = status == I2C_STATUS_SUCCESS && azoteq_iqs7211e_ati_monitor(&base_data);
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+            if (status == I2C_STATUS_SUCCESS) {
+                azoteq_iqs7211e_power_update(base_data.info_flags[0]);
+            }
+#endif
+#ifdef AZOTEQ_IQS7211E_NOISE_HOP_ENABLE
+            if (status == I2C_STATUS_SUCCESS && !discard) {
+                azoteq_iqs7211e_noise_monitor(&base_data);
+            }
+#endif
+#ifdef AZOTEQ_IQS7211E_DIAG_ENABLE
+            azoteq_iqs7211e_diag_task();
+#endif
+            azoteq_iqs7211e_end_session();
+
+            if (discard) {
+                // Coordinates are meaningless while ATI runs
+                return motion;
+            }
+
+#ifdef AZOTEQ_IQS7211E_PTP_ENABLE
+            if (status == I2C_STATUS_SUCCESS && azoteq_iqs7211e_ptp_active()) {
+                // The host does gesture recognition; forward the contacts and skip everything below
+                azoteq_iqs7211e_ptp_report_t ptp_report;
+                azoteq_iqs7211e_ptp_fill(&ptp_report, &base_data, capture_us);
+                azoteq_iqs7211e_ptp_send(&ptp_report);
+                azoteq_iqs7211e_frame_stats.frames++;
+                return motion;
+            }
+#else
+            (void)capture_us;
+#endif
 
             if (status == I2C_STATUS_SUCCESS) {
-                uint8_t finger_count = base_data.info_flags[1] & 0x03;
-                uint32_t current_time = timer_read32();
+                uint16_t finger_x[AZOTEQ_IQS7211E_MAX_CONTACTS], finger_y[AZOTEQ_IQS7211E_MAX_CONTACTS];
+                uint8_t  finger_count    = azoteq_iqs7211e_present_fingers(&base_data, finger_x, finger_y);
+                uint8_t  previous_count  = azoteq_iqs7211e_tracker.count;
+                bool     movement        = base_data.info_flags[1] & (1 << IQS7211E_TP_MOVEMENT_BIT);
+                uint32_t current_time    = azoteq_iqs7211e_clock_ms();
+
+                uint16_t frame_dt        = current_time - last_frame_time;
+                last_frame_time          = current_time;
+
+                azoteq_iqs7211e_frame_stats.frames++;
+
+#ifdef AZOTEQ_IQS7211E_TRACE_ENABLE
+                // One line per frame for offline evaluation: T,time,fingers,x1,y1,x2,y2 with the slots as reported
+                dprintf("T,%lu,%u,%u,%u,%u,%u\n", (unsigned long)current_time, finger_count, azoteq_iqs7211e_finger_x(&base_data, 0), azoteq_iqs7211e_finger_y(&base_data, 0), azoteq_iqs7211e_finger_x(&base_data, 1), azoteq_iqs7211e_finger_y(&base_data, 1));
+#endif
 
                 // Handle pending click releases
                 if (pending_click_release > 0) {
-                    if (timer_elapsed32(pending_click_release) > 50) {
+                    if (azoteq_iqs7211e_elapsed_ms(pending_click_release) > 50) {
                         if (pending_click_release == 1) {
-                            temp_report.buttons &= ~MOUSE_BTN1;
+                            motion.buttons &= ~AZOTEQ_IQS7211E_BUTTON_1;
                         } else if (pending_click_release == 2) {
-                            temp_report.buttons &= ~MOUSE_BTN2;
+                            motion.buttons &= ~AZOTEQ_IQS7211E_BUTTON_2;
                         }
                         pending_click_release = 0;
                     }
                 }
 
-                if (finger_count == 1) {
-                    // Single finger handling
-                    uint16_t finger_1_x = AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(base_data.finger_1_x.h, base_data.finger_1_x.l);
-                    uint16_t finger_1_y = AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(base_data.finger_1_y.h, base_data.finger_1_y.l);
+#ifdef AZOTEQ_IQS7211E_FILTER_ENABLE
+                // Fingers that stopped are decoded until the filtered contacts have caught up with them
+                if (!azoteq_iqs7211e_tracker_settled(&azoteq_iqs7211e_tracker)) {
+                    movement = true;
+                }
+#endif
+#ifdef AZOTEQ_IQS7211E_PREDICT_ENABLE
+                // A finger that stopped is decoded until the cursor has eased back onto it
+                if (finger_count == 1 && !azoteq_iqs7211e_predictor_settled(&azoteq_iqs7211e_predictor)) {
+                    movement = true;
+                }
+#endif
+                if (!movement && finger_count == previous_count) {
+                    // Fast path: nothing moved and no finger came or went, skip decoding
+                    azoteq_iqs7211e_frame_stats.fast_path_frames++;
+                } else {
+                    // Match reported fingers to tracked contacts so deltas are per physical finger
+                    azoteq_iqs7211e_tracker_update(&azoteq_iqs7211e_tracker, finger_count, finger_x, finger_y, frame_dt);
 
-                    if (!previous_valid) {
+                    if (previous_count == 0 && finger_count > 0) {
                         // Touch start
-                        tap_start_x = finger_1_x;
-                        tap_start_y = finger_1_y;
-                        touch_start_time = current_time;
-                    } else if (finger_2_prev_valid) {
-                        // Transitioning from two finger to one finger - reset position reference
-                        tap_start_x = finger_1_x;
-                        tap_start_y = finger_1_y;
                         touch_start_time = current_time;
-                        tap_count = 0;
-                        double_tap_hold = false;
-                        is_clicking = false;
-                    } else {
-                        // Normal single finger movement
-                        int16_t delta_x = finger_1_x - previous_x;
-                        int16_t delta_y = finger_1_y - previous_y;
-
-                        temp_report.x = CONSTRAIN_HID_XY(delta_x);
-                        temp_report.y = CONSTRAIN_HID_XY(delta_y);
+                        max_finger_count = 0;
+                    }
+                    if (finger_count > max_finger_count) {
+                        max_finger_count = finger_count;
+                    }
+#ifdef AZOTEQ_IQS7211E_PALM_REJECT_ENABLE
+                    // Once rejected, a touch stays rejected until every finger lifts
+                    if (finger_count > 0 && !touch_rejected && (azoteq_iqs7211e_is_palm(&base_data) || azoteq_iqs7211e_typing_elapsed_ms() < AZOTEQ_IQS7211E_TYPING_TIMEOUT_MS)) {
+                        touch_rejected = true;
+                        azoteq_iqs7211e_frame_stats.rejected_touches++;
+                    }
+#endif
+#ifdef AZOTEQ_IQS7211E_RIM_SCROLL_ENABLE
+                    if (finger_count != 1) {
+                        azoteq_iqs7211e_rim_active = false;
+                    }
+#endif
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+                    if (finger_count != 2) {
+                        azoteq_iqs7211e_pinch_end(&azoteq_iqs7211e_pinch);
                     }
+#endif
 
-                    previous_x = finger_1_x;
-                    previous_y = finger_1_y;
-                    previous_valid = true;
-                    finger_2_prev_valid = false;
-
-                } else if (finger_count == 2) {
-                    // Two finger handling
-                    uint16_t finger_1_x = AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(base_data.finger_1_x.h, base_data.finger_1_x.l);
-                    uint16_t finger_1_y = AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(base_data.finger_1_y.h, base_data.finger_1_y.l);
-                    uint16_t finger_2_x = AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(base_data.finger_2_x.h, base_data.finger_2_x.l);
-                    
-                    // Read finger 2 Y coordinate (need additional read)
-                    uint8_t finger_2_y_bytes[2];
-                    i2c_status_t finger2_status = i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, 0x17, finger_2_y_bytes, 2, AZOTEQ_IQS7211E_TIMEOUT_MS); // IQS7211E_MM_FINGER_2_Y
-                    uint16_t finger_2_y = (finger2_status == I2C_STATUS_SUCCESS) ? AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(finger_2_y_bytes[1], finger_2_y_bytes[0]) : 0;
-
-                    if (!finger_2_prev_valid) {
-                        // Two finger touch start
-                        touch_start_time = current_time;
-                        tap_count = 0;
-                        double_tap_hold = false;
-                        if (is_clicking) {
-                            is_clicking = false;
-                            temp_report.buttons &= ~MOUSE_BTN1;
+                    if (touch_rejected) {
+                        // Palm or typing: keep tracking contacts but send nothing
+                        if (finger_count == 0) {
+                            touch_rejected = false;
+                        }
+                    } else if (finger_count == 1) {
+                        // Single finger handling, also right after lifting one of two fingers
+                        const azoteq_iqs7211e_contact_t *contact = azoteq_iqs7211e_tracker_primary(&azoteq_iqs7211e_tracker);
+
+                        if (previous_count == 0) {
+                            tap_start_x = contact->x;
+                            tap_start_y = contact->y;
+#ifdef AZOTEQ_IQS7211E_RIM_SCROLL_ENABLE
+                            // A touch landing on the rim scrolls by circling instead of moving the pointer
+                            azoteq_iqs7211e_rim_active = azoteq_iqs7211e_rim_is_edge(contact->x, contact->y);
+                            if (azoteq_iqs7211e_rim_active) {
+                                azoteq_iqs7211e_rim_start(&azoteq_iqs7211e_rim, contact->x, contact->y);
+                            }
+#endif
                         }
-                    } else {
-                        // Two finger movement - scroll
-                        int16_t y_movement = (finger_1_y + finger_2_y) / 2 - (previous_y + finger_2_prev_y) / 2;
-                        int16_t x_movement = (finger_1_x + finger_2_x) / 2 - (previous_x + finger_2_prev_x) / 2;
 
+                        int16_t delta_x = 0, delta_y = 0;
+#ifdef AZOTEQ_IQS7211E_RIM_SCROLL_ENABLE
+                        if (azoteq_iqs7211e_rim_active) {
+                            motion.v = azoteq_iqs7211e_rim_update(&azoteq_iqs7211e_rim, contact->x, contact->y);
+                        } else
+#endif
+                        if (!contact->persisted) {
+#ifdef AZOTEQ_IQS7211E_PREDICT_ENABLE
+                            azoteq_iqs7211e_predictor_reset(&azoteq_iqs7211e_predictor, contact->x, contact->y);
+#endif
+                        } else {
+#ifdef AZOTEQ_IQS7211E_PREDICT_ENABLE
+                            // Extrapolate to the expected send time to hide sensor and bus latency
+                            azoteq_iqs7211e_predictor_update(&azoteq_iqs7211e_predictor, contact->x, contact->y, frame_dt, &delta_x, &delta_y);
+#else
+                            delta_x = contact->dx;
+                            delta_y = contact->dy;
+#endif
+                        }
+
+                        azoteq_iqs7211e_transform(&delta_x, &delta_y, &azoteq_iqs7211e_pointer_residue);
+                        delta_x = azoteq_iqs7211e_units_scale(delta_x, azoteq_iqs7211e_units.pointer_scale, &azoteq_iqs7211e_pointer_remainder[0]);
+                        delta_y = azoteq_iqs7211e_units_scale(delta_y, azoteq_iqs7211e_units.pointer_scale, &azoteq_iqs7211e_pointer_remainder[1]);
+                        motion.x = delta_x;
+                        motion.y = delta_y;
+
+                        last_x = contact->x;
+                        last_y = contact->y;
+
+                    } else if (finger_count == 2) {
+                        // Two finger handling
+                        if (previous_count < 2) {
+                            // Two finger touch start
+                            tap_count = 0;
+                            double_tap_hold = false;
+                            if (is_clicking) {
+                                is_clicking = false;
+                                motion.buttons &= ~AZOTEQ_IQS7211E_BUTTON_1;
+                            }
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+                            azoteq_iqs7211e_pinch_start(&azoteq_iqs7211e_pinch, &azoteq_iqs7211e_tracker);
+#endif
+                        }
+
+                        // Scroll with the mean motion of the fingers that were already down
+                        int16_t x_movement = 0, y_movement = 0;
+                        uint8_t persisted  = 0;
+                        for (uint8_t i = 0; i < AZOTEQ_IQS7211E_MAX_CONTACTS; i++) {
+                            const azoteq_iqs7211e_contact_t *contact = &azoteq_iqs7211e_tracker.contact[i];
+                            if (contact->active && contact->persisted) {
+                                x_movement += contact->dx;
+                                y_movement += contact->dy;
+                                persisted++;
+                            }
+                        }
+
+                        if (persisted > 1) {
+                            x_movement /= persisted;
+                            y_movement /= persisted;
+                        }
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+                        // Scroll only once the touch is not a pinch or rotate
+                        if (!azoteq_iqs7211e_pinch_update(&azoteq_iqs7211e_pinch, &azoteq_iqs7211e_tracker, x_movement, y_movement, &motion)) {
+                            x_movement = 0;
+                            y_movement = 0;
+                        }
+#endif
+                        azoteq_iqs7211e_transform(&x_movement, &y_movement, &azoteq_iqs7211e_scroll_residue);
+                        x_movement = azoteq_iqs7211e_units_scale(x_movement, azoteq_iqs7211e_units.scroll_scale, &azoteq_iqs7211e_scroll_remainder[0]);
+                        y_movement = azoteq_iqs7211e_units_scale(y_movement, azoteq_iqs7211e_units.scroll_scale, &azoteq_iqs7211e_scroll_remainder[1]);
                         if (y_movement != 0) {
-                            temp_report.v = CONSTRAIN_HID(-y_movement); // Scroll wheel
+                            motion.v = -y_movement; // Scroll wheel
                         }
                         if (x_movement != 0) {
-                            temp_report.h = CONSTRAIN_HID(x_movement); // Horizontal scroll
+                            motion.h = x_movement; // Horizontal scroll
                         }
-                    }
 
-                    previous_x = finger_1_x;
-                    previous_y = finger_1_y;
-                    finger_2_prev_x = finger_2_x;
-                    finger_2_prev_y = finger_2_y;
-                    previous_valid = true;
-                    finger_2_prev_valid = true;
+                    } else if (previous_count > 0) {
+                        // No fingers - handle touch end events
+                        uint16_t touch_duration = (uint16_t)azoteq_iqs7211e_elapsed_ms(touch_start_time);
 
-                } else {
-                    // No fingers - handle touch end events
-                    if (previous_valid || finger_2_prev_valid) {
-                        uint16_t touch_duration = timer_elapsed(touch_start_time);
-
-                        if (finger_2_prev_valid) {
-                            // Two finger tap - right click
+                        if (max_finger_count == 2) {
+                            // Two finger tap - right click, even if the fingers lifted in different frames
                             if (touch_duration < 200) {
-                                temp_report.buttons |= MOUSE_BTN2;
+                                motion.buttons |= AZOTEQ_IQS7211E_BUTTON_2;
                                 pending_click_release = 2;
                             }
-                        } else if (previous_valid) {
+                        } else {
                             // Single finger tap handling
-                            uint16_t tap_distance = abs(previous_x - tap_start_x) + abs(previous_y - tap_start_y);
+                            uint16_t tap_distance = abs(last_x - tap_start_x) + abs(last_y - tap_start_y);
 
-                            if (touch_duration < 200 && tap_distance < 50) {
-                                uint16_t tap_interval = timer_elapsed(last_tap_time);
+                            if (touch_duration < 200 && tap_distance < azoteq_iqs7211e_units.tap_distance) {
+                                uint16_t tap_interval = (uint16_t)azoteq_iqs7211e_elapsed_ms(last_tap_time);
 
                                 if (tap_interval < 400 && tap_count == 1) {
                                     // Double tap - start drag
                                     double_tap_hold = true;
                                     is_clicking = true;
-                                    temp_report.buttons |= MOUSE_BTN1;
+                                    motion.buttons |= AZOTEQ_IQS7211E_BUTTON_1;
                                     tap_count = 0;
                                 } else {
                                     // Single tap
                                     if (!double_tap_hold) {
-                                        temp_report.buttons |= MOUSE_BTN1;
+                                        motion.buttons |= AZOTEQ_IQS7211E_BUTTON_1;
                                         pending_click_release = 1;
                                     }
                                     tap_count = 1;
@@ -717,48 +1219,42 @@ report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report) {
                                 // Release double-tap hold
                                 double_tap_hold = false;
                                 is_clicking = false;
-                                temp_report.buttons &= ~MOUSE_BTN1;
+                                motion.buttons &= ~AZOTEQ_IQS7211E_BUTTON_1;
                             }
 
                             // Reset tap count if too much time passed
-                            if (timer_elapsed(last_tap_time) > 600) {
+                            if ((uint16_t)azoteq_iqs7211e_elapsed_ms(last_tap_time) > 600) {
                                 tap_count = 0;
                             }
                         }
                     }
-
-                    previous_valid = false;
-                    finger_2_prev_valid = false;
                 }
 
                 // Maintain double-tap hold click
                 if (double_tap_hold && is_clicking) {
-                    temp_report.buttons |= MOUSE_BTN1;
+                    motion.buttons |= AZOTEQ_IQS7211E_BUTTON_1;
                 }
 
+#ifdef AZOTEQ_IQS7211E_FRAME_STATS_INTERVAL
+                if (azoteq_iqs7211e_frame_stats.frames % AZOTEQ_IQS7211E_FRAME_STATS_INTERVAL == 0) {
+                    dprintf("IQS7211E: %lu frames, %lu fast path, %lu touches rejected\n", (unsigned long)azoteq_iqs7211e_frame_stats.frames, (unsigned long)azoteq_iqs7211e_frame_stats.fast_path_frames, (unsigned long)azoteq_iqs7211e_frame_stats.rejected_touches);
+                    dprintf("IQS7211E: re-ATI %u sensor, %u driver, %u ATI errors, %u stuck touches, %u frequency hops\n", azoteq_iqs7211e_frame_stats.sensor_reati, azoteq_iqs7211e_frame_stats.driver_reati, azoteq_iqs7211e_frame_stats.ati_errors, azoteq_iqs7211e_frame_stats.stuck_touches, azoteq_iqs7211e_frame_stats.frequency_hops);
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+                    azoteq_iqs7211e_power_stats_t power_stats;
+                    azoteq_iqs7211e_power_get_stats(&power_stats);
+                    dprintf("IQS7211E: ms per mode %lu active, %lu idle touch, %lu idle, %lu LP1, %lu LP2\n", (unsigned long)power_stats.residency_ms[AZOTEQ_IQS7211E_POWER_ACTIVE], (unsigned long)power_stats.residency_ms[AZOTEQ_IQS7211E_POWER_IDLE_TOUCH], (unsigned long)power_stats.residency_ms[AZOTEQ_IQS7211E_POWER_IDLE], (unsigned long)power_stats.residency_ms[AZOTEQ_IQS7211E_POWER_LP1], (unsigned long)power_stats.residency_ms[AZOTEQ_IQS7211E_POWER_LP2]);
+                    dprintf("IQS7211E: ~%u uA, %lu transfers, %lu bytes, %lu wakes\n", power_stats.average_ua, (unsigned long)power_stats.transfers, (unsigned long)power_stats.transfer_bytes, (unsigned long)power_stats.wakes);
+#endif
+                }
+#endif
+
             } else {
-                dprintf("IQS7211E: Get report failed, i2c status: %d\n", status);
+                AZOTEQ_IQS7211E_LOG(FRAME_FAILED, status, 0);
             }
+        } else {
+            azoteq_iqs7211e_reati_idle_task();
         }
-    } else {
-        dprintf("IQS7211E: Init failed, i2c status: %d, %d\n", azoteq_iqs7211e_init_status, azoteq_iqs7211e_product_number);
     }
 
-    return temp_report;
-}
-
-void pointing_device_driver_init(void) {
-    azoteq_iqs7211e_init();
+    return motion;
 }
-
-report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
-    return azoteq_iqs7211e_get_report(mouse_report);
-}
-
-void pointing_device_driver_set_cpi(uint16_t cpi) {
-    azoteq_iqs7211e_set_cpi(cpi);
-}
-
-uint16_t pointing_device_driver_get_cpi(void) {
-    return azoteq_iqs7211e_get_cpi();
-}
\ No newline at end of file
@@ -18,19 +18,54 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <stdint.h>
-#include "i2c_master.h"
-#include "pointing_device.h"
+#include <stddef.h>
+#include "azoteq_iqs7211e_platform.h"
+#include "azoteq_iqs7211e_tunables.h"
 
-#ifndef AZOTEQ_IQS7211E_ADDRESS
-#    define AZOTEQ_IQS7211E_ADDRESS (0x56 << 1)
+// I2C bus profile tried first at init; slower profiles are used as fallback
+// on platforms that let the driver set the bus clock, elsewhere it is fixed
+#ifndef AZOTEQ_IQS7211E_BUS_PROFILE
+#    define AZOTEQ_IQS7211E_BUS_PROFILE AZOTEQ_IQS7211E_BUS_FAST
 #endif
 
-#ifndef AZOTEQ_IQS7211E_TIMEOUT_MS
-#    define AZOTEQ_IQS7211E_TIMEOUT_MS 100
+// Consecutive failed frame reads before stepping down one bus profile
+#ifndef AZOTEQ_IQS7211E_BUS_FALLBACK_ERRORS
+#    define AZOTEQ_IQS7211E_BUS_FALLBACK_ERRORS 8
 #endif
 
-#ifndef AZOTEQ_IQS7211E_RDY_PIN
-#    define AZOTEQ_IQS7211E_RDY_PIN 21
+// Frame reads per profile in azoteq_iqs7211e_bus_benchmark
+#ifndef AZOTEQ_IQS7211E_BENCHMARK_FRAMES
+#    define AZOTEQ_IQS7211E_BENCHMARK_FRAMES 64
+#endif
+
+// Sensing area edge length (pad diameter), used for physical units
+#ifndef AZOTEQ_IQS7211E_PAD_SIZE_MM
+#    define AZOTEQ_IQS7211E_PAD_SIZE_MM 30
+#endif
+
+// Finger area, in sensor units, above which a contact is treated as a palm
+#ifndef AZOTEQ_IQS7211E_PALM_AREA
+#    define AZOTEQ_IQS7211E_PALM_AREA 40
+#endif
+
+// Touches starting or lasting within this time after a key event are ignored
+#ifndef AZOTEQ_IQS7211E_TYPING_TIMEOUT_MS
+#    define AZOTEQ_IQS7211E_TYPING_TIMEOUT_MS 300
+#endif
+
+// Requested re-ATIs (tunable changes, frequency hops, drift) run only once the pad has been untouched this long
+#ifndef AZOTEQ_IQS7211E_REATI_IDLE_MS
+#    define AZOTEQ_IQS7211E_REATI_IDLE_MS 2000
+#endif
+
+// A contact reported without any movement for this long is taken as baseline drift
+#ifndef AZOTEQ_IQS7211E_REATI_STUCK_MS
+#    define AZOTEQ_IQS7211E_REATI_STUCK_MS 15000
+#endif
+
+// Frames after a driver re-ATI are discarded for this long while the baseline settles
+#ifndef AZOTEQ_IQS7211E_REATI_SETTLE_MS
+#    define AZOTEQ_IQS7211E_REATI_SETTLE_MS 100
 #endif
 
 // Product number
@@ -48,8 +83,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IQS7211E_MM_INFO_FLAGS 0x0F
 #define IQS7211E_MM_FINGER_1_X 0x10
 #define IQS7211E_MM_FINGER_1_Y 0x11
+#define IQS7211E_MM_FINGER_1_STRENGTH 0x12
+#define IQS7211E_MM_FINGER_1_AREA 0x13
 #define IQS7211E_MM_FINGER_2_X 0x14
 #define IQS7211E_MM_FINGER_2_Y 0x15
+#define IQS7211E_MM_FINGER_2_STRENGTH 0x16
+#define IQS7211E_MM_FINGER_2_AREA 0x17
 #define IQS7211E_MM_SYS_CONTROL 0x33
 #define IQS7211E_MM_CONFIG_SETTINGS 0x34
 #define IQS7211E_MM_X_RESOLUTION 0x43
@@ -69,81 +108,208 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IQS7211E_MM_PROXA_CYCLE0 0x5D
 #define IQS7211E_MM_PROXA_CYCLE10 0x6C
 #define IQS7211E_MM_PROXA_CYCLE20 0x7B
+#define IQS7211E_MM_END_SESSION 0xFF
 
 // Bit definitions
 #define IQS7211E_SHOW_RESET_BIT 7
+#define IQS7211E_ATI_ERROR_BIT 3
 #define IQS7211E_RE_ATI_OCCURRED_BIT 4
+#define IQS7211E_ALP_ATI_ERROR_BIT 5
+#define IQS7211E_ALP_RE_ATI_OCCURRED_BIT 6
 #define IQS7211E_ACK_RESET_BIT 7
 #define IQS7211E_TP_RE_ATI_BIT 5
 #define IQS7211E_ALP_RE_ATI_BIT 6
 #define IQS7211E_SW_RESET_BIT 1
 #define IQS7211E_EVENT_MODE_BIT 0
+#define IQS7211E_COMMS_END_CMD_BIT 2
 #define IQS7211E_TP_MOVEMENT_BIT 2
 #define IQS7211E_NUM_FINGERS_BIT_0 1
 #define IQS7211E_NUM_FINGERS_BIT_1 2
+#define IQS7211E_TOO_MANY_FINGERS_BIT 4
+#define IQS7211E_CHARGING_MODE_MASK 0x07
+#define IQS7211E_FINGER_COUNT_MASK 0x03
 
 // Gesture bits
 #define IQS7211E_GESTURE_SINGLE_TAP_BIT 0
 #define IQS7211E_GESTURE_PRESS_HOLD_BIT 3
+#define IQS7211E_GESTURE_PALM_BIT 4
 
 // Byte swap macros
 #define AZOTEQ_IQS7211E_SWAP_H_L_BYTES(x) (((x & 0xFF) << 8) | ((x & 0xFF00) >> 8))
-#define AZOTEQ_IQS7211E_COMBINE_H_L_BYTES(h, l) (((int16_t)(h << 8)) | l)
+#define AZOTEQ_IQS7211E_LOW_BYTE(x) ((uint8_t)((x) & 0xFF))
+#define AZOTEQ_IQS7211E_HIGH_BYTE(x) ((uint8_t)(((x) >> 8) & 0xFF))
 
 // Data structures
-typedef union {
-    struct {
-        uint8_t l;
-        uint8_t h;
-    };
-    uint16_t combined;
-} azoteq_iqs7211e_report_rate_t;
-
-typedef union {
-    struct {
-        uint8_t l;
-        uint8_t h;
-    };
-    int16_t combined;
-} azoteq_iqs7211e_coordinate_t;
+typedef enum {
+    AZOTEQ_IQS7211E_BUS_STANDARD = 0, // 100 kHz
+    AZOTEQ_IQS7211E_BUS_FAST,         // 400 kHz
+    AZOTEQ_IQS7211E_BUS_FAST_PLUS,    // 1 MHz
+    AZOTEQ_IQS7211E_BUS_PROFILE_COUNT,
+} azoteq_iqs7211e_bus_profile_t;
 
-typedef struct {
-    azoteq_iqs7211e_coordinate_t relative_x;
-    azoteq_iqs7211e_coordinate_t relative_y;
-    azoteq_iqs7211e_coordinate_t gesture_x;
-    azoteq_iqs7211e_coordinate_t gesture_y;
-    uint8_t                      gestures[2];
-    uint8_t                      info_flags[2];
-    azoteq_iqs7211e_coordinate_t finger_1_x;
-    azoteq_iqs7211e_coordinate_t finger_1_y;
-    azoteq_iqs7211e_coordinate_t finger_2_x;
-    azoteq_iqs7211e_coordinate_t finger_2_y;
+// Register layouts. Registers are 16 bit words sent low byte first; bursts
+// are read straight into these packed structs and decoded with the accessors
+// below, which compile to plain loads on little-endian MCUs.
+typedef struct __attribute__((packed)) {
+    uint8_t l;
+    uint8_t h;
+} azoteq_iqs7211e_le16_t;
+
+static inline uint16_t azoteq_iqs7211e_le16(azoteq_iqs7211e_le16_t word) {
+    return (uint16_t)word.l | ((uint16_t)word.h << 8);
+}
+
+static inline int16_t azoteq_iqs7211e_le16_signed(azoteq_iqs7211e_le16_t word) {
+    return (int16_t)azoteq_iqs7211e_le16(word);
+}
+
+// Version block, 0x00 - 0x02
+typedef struct __attribute__((packed)) {
+    azoteq_iqs7211e_le16_t product_number;
+    azoteq_iqs7211e_le16_t major_version;
+    azoteq_iqs7211e_le16_t minor_version;
+} azoteq_iqs7211e_version_data_t;
+
+// One finger, 0x10 - 0x13 and 0x14 - 0x17
+typedef struct __attribute__((packed)) {
+    azoteq_iqs7211e_le16_t x;
+    azoteq_iqs7211e_le16_t y;
+    azoteq_iqs7211e_le16_t strength;
+    azoteq_iqs7211e_le16_t area;
+} azoteq_iqs7211e_finger_data_t;
+
+// Frame block, 0x0A - 0x17; relative X/Y are signed, everything else unsigned
+typedef struct __attribute__((packed)) {
+    azoteq_iqs7211e_le16_t        relative_x;
+    azoteq_iqs7211e_le16_t        relative_y;
+    azoteq_iqs7211e_le16_t        gesture_x;
+    azoteq_iqs7211e_le16_t        gesture_y;
+    uint8_t                       gestures[2];
+    uint8_t                       info_flags[2];
+    azoteq_iqs7211e_finger_data_t finger[2];
 } azoteq_iqs7211e_base_data_t;
 
+// Bytes in one frame burst, 0x0A - 0x17
+#define AZOTEQ_IQS7211E_BASE_DATA_SIZE 28
+
+#define AZOTEQ_IQS7211E_ASSERT_REGISTER(type, field, first, reg) _Static_assert(offsetof(type, field) == ((reg) - (first)) * 2, #type "." #field " is not at " #reg)
+
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_version_data_t, product_number, IQS7211E_MM_PROD_NUM, IQS7211E_MM_PROD_NUM);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_version_data_t, major_version, IQS7211E_MM_PROD_NUM, IQS7211E_MM_MAJOR_VERSION_NUM);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_version_data_t, minor_version, IQS7211E_MM_PROD_NUM, IQS7211E_MM_MINOR_VERSION_NUM);
+_Static_assert(sizeof(azoteq_iqs7211e_version_data_t) == (IQS7211E_MM_MINOR_VERSION_NUM - IQS7211E_MM_PROD_NUM + 1) * 2, "azoteq_iqs7211e_version_data_t size");
+
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, relative_x, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_RELATIVE_X);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, relative_y, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_RELATIVE_Y);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, gesture_x, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_GESTURE_X);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, gesture_y, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_GESTURE_Y);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, gestures, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_GESTURES);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, info_flags, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_INFO_FLAGS);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[0].x, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_1_X);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[0].y, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_1_Y);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[0].strength, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_1_STRENGTH);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[0].area, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_1_AREA);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[1].x, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_2_X);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[1].y, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_2_Y);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[1].strength, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_2_STRENGTH);
+AZOTEQ_IQS7211E_ASSERT_REGISTER(azoteq_iqs7211e_base_data_t, finger[1].area, IQS7211E_MM_RELATIVE_X, IQS7211E_MM_FINGER_2_AREA);
+_Static_assert(sizeof(azoteq_iqs7211e_base_data_t) == AZOTEQ_IQS7211E_BASE_DATA_SIZE, "azoteq_iqs7211e_base_data_t size");
+
+static inline uint8_t azoteq_iqs7211e_finger_count(const azoteq_iqs7211e_base_data_t *base_data) {
+    return base_data->info_flags[1] & IQS7211E_FINGER_COUNT_MASK;
+}
+
+static inline int16_t azoteq_iqs7211e_relative_x(const azoteq_iqs7211e_base_data_t *base_data) {
+    return azoteq_iqs7211e_le16_signed(base_data->relative_x);
+}
+
+static inline int16_t azoteq_iqs7211e_relative_y(const azoteq_iqs7211e_base_data_t *base_data) {
+    return azoteq_iqs7211e_le16_signed(base_data->relative_y);
+}
+
+static inline uint16_t azoteq_iqs7211e_finger_x(const azoteq_iqs7211e_base_data_t *base_data, uint8_t finger) {
+    return azoteq_iqs7211e_le16(base_data->finger[finger].x);
+}
+
+static inline uint16_t azoteq_iqs7211e_finger_y(const azoteq_iqs7211e_base_data_t *base_data, uint8_t finger) {
+    return azoteq_iqs7211e_le16(base_data->finger[finger].y);
+}
+
+// The sensor keeps each finger in its own slot while it is down and marks an empty slot with 0xFFFF coordinates
+static inline bool azoteq_iqs7211e_finger_present(const azoteq_iqs7211e_base_data_t *base_data, uint8_t finger) {
+    return azoteq_iqs7211e_finger_x(base_data, finger) != 0xFFFF;
+}
+
+static inline uint16_t azoteq_iqs7211e_finger_strength(const azoteq_iqs7211e_base_data_t *base_data, uint8_t finger) {
+    return azoteq_iqs7211e_le16(base_data->finger[finger].strength);
+}
+
+static inline uint16_t azoteq_iqs7211e_finger_area(const azoteq_iqs7211e_base_data_t *base_data, uint8_t finger) {
+    return azoteq_iqs7211e_le16(base_data->finger[finger].area);
+}
+
+// Frame counters, fast_path_frames counts frames without movement or finger count change
+typedef struct {
+    uint32_t frames;
+    uint32_t fast_path_frames;
+    uint32_t rejected_touches;
+    uint16_t sensor_reati;   // re-ATI completions flagged by the sensor
+    uint16_t driver_reati;   // re-ATI runs requested by the drift monitor
+    uint16_t ati_errors;     // frames entering the ATI error state
+    uint16_t stuck_touches;  // contacts that stayed frozen for AZOTEQ_IQS7211E_REATI_STUCK_MS
+    uint16_t frequency_hops; // conversion frequency changes on noise
+} azoteq_iqs7211e_frame_stats_t;
+
 // Resolution structure
 typedef struct {
     uint16_t x_resolution;
     uint16_t y_resolution;
 } azoteq_iqs7211e_resolution_t;
 
+#define AZOTEQ_IQS7211E_BUTTON_1 0x01
+#define AZOTEQ_IQS7211E_BUTTON_2 0x02
+
+// Platform independent output of one frame; the adapter maps it onto its
+// own report and applies its own range limits
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t v;
+    int16_t h;
+    uint8_t buttons;
+} azoteq_iqs7211e_motion_t;
+
 // Function declarations
-void           azoteq_iqs7211e_init(void);
-report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report);
-void           azoteq_iqs7211e_set_cpi(uint16_t cpi);
-uint16_t       azoteq_iqs7211e_get_cpi(void);
+void                     azoteq_iqs7211e_init(void);
+azoteq_iqs7211e_motion_t azoteq_iqs7211e_read_motion(void);
+void                     azoteq_iqs7211e_set_cpi(uint16_t cpi);
+uint16_t                 azoteq_iqs7211e_get_cpi(void);
+void                     azoteq_iqs7211e_get_frame_stats(azoteq_iqs7211e_frame_stats_t *stats);
+void                     azoteq_iqs7211e_reset_frame_stats(void);
+void                     azoteq_iqs7211e_request_reati(void);
 
-// Low-level functions
+// Bus profile functions
+azoteq_iqs7211e_bus_profile_t azoteq_iqs7211e_get_bus_profile(void);
+#ifndef AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+bool azoteq_iqs7211e_set_bus_profile(azoteq_iqs7211e_bus_profile_t profile);
+void azoteq_iqs7211e_bus_benchmark(uint32_t frame_read_us[AZOTEQ_IQS7211E_BUS_PROFILE_COUNT]);
+#endif
+
+// Session functions
+bool         azoteq_iqs7211e_begin_session(uint16_t timeout_ms);
 i2c_status_t azoteq_iqs7211e_end_session(void);
+uint16_t     azoteq_iqs7211e_get_frame_interval(void);
+
+// Low-level functions
 i2c_status_t azoteq_iqs7211e_get_base_data(azoteq_iqs7211e_base_data_t *base_data);
 i2c_status_t azoteq_iqs7211e_reset_suspend(bool reset, bool suspend);
 i2c_status_t azoteq_iqs7211e_set_event_mode(bool enabled);
 i2c_status_t azoteq_iqs7211e_acknowledge_reset(void);
 i2c_status_t azoteq_iqs7211e_reati(void);
 i2c_status_t azoteq_iqs7211e_write_memory_map(void);
+i2c_status_t azoteq_iqs7211e_write_block(azoteq_iqs7211e_block_t block);
 i2c_status_t azoteq_iqs7211e_check_reset(void);
 bool         azoteq_iqs7211e_read_ati_active(void);
 bool         azoteq_iqs7211e_is_ready(void);
 void         azoteq_iqs7211e_wait_for_ready(uint16_t timeout_ms);
 uint16_t     azoteq_iqs7211e_get_product(void);
-
-extern const pointing_device_driver_t azoteq_iqs7211e_pointing_device_driver;
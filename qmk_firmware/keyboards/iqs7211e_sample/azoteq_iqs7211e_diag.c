@@ -0,0 +1,142 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_diag.h"
+#include "azoteq_iqs7211e_log.h"
+#include "IQS7211_init.h"
+
+#ifdef AZOTEQ_IQS7211E_DIAG_ENABLE
+
+// VIA owns the raw HID stream and only answers requests, so heatmaps go to
+// the console there, and to unsolicited packets only in plain raw HID builds
+#if defined(RAW_ENABLE) && !defined(VIA_ENABLE)
+#    include "raw_hid.h"
+#    define AZOTEQ_IQS7211E_DIAG_RAW_HID
+#endif
+
+// Register of the first trackpad channel word in each table, from the
+// datasheet revision matching the sensor firmware
+#if !defined(AZOTEQ_IQS7211E_DIAG_COUNTS_ADDRESS) || !defined(AZOTEQ_IQS7211E_DIAG_DELTAS_ADDRESS)
+#    error "Define AZOTEQ_IQS7211E_DIAG_COUNTS_ADDRESS and AZOTEQ_IQS7211E_DIAG_DELTAS_ADDRESS to use the diagnostic readout"
+#endif
+
+// Total Rx and Tx from the trackpad settings, one channel per crossing
+#define AZOTEQ_IQS7211E_DIAG_RX TRACKPAD_SETTINGS_0_1
+#define AZOTEQ_IQS7211E_DIAG_TX TRACKPAD_SETTINGS_1_0
+#define AZOTEQ_IQS7211E_DIAG_CHANNELS (AZOTEQ_IQS7211E_DIAG_RX * AZOTEQ_IQS7211E_DIAG_TX)
+
+#define AZOTEQ_IQS7211E_DIAG_HEADER_SIZE 6
+#define AZOTEQ_IQS7211E_DIAG_PACKET_SIZE 32
+
+_Static_assert(AZOTEQ_IQS7211E_DIAG_HEADER_SIZE + AZOTEQ_IQS7211E_DIAG_CHUNK * 2 <= AZOTEQ_IQS7211E_DIAG_PACKET_SIZE, "AZOTEQ_IQS7211E_DIAG_CHUNK too large for one packet");
+
+static const uint8_t azoteq_iqs7211e_diag_address[AZOTEQ_IQS7211E_DIAG_KIND_COUNT] = {
+    [AZOTEQ_IQS7211E_DIAG_COUNTS] = AZOTEQ_IQS7211E_DIAG_COUNTS_ADDRESS,
+    [AZOTEQ_IQS7211E_DIAG_DELTAS] = AZOTEQ_IQS7211E_DIAG_DELTAS_ADDRESS,
+};
+
+#if defined(VIA_ENABLE) || defined(RAW_ENABLE)
+// Host tool users start the stream with AZOTEQ_IQS7211E_DIAG_VALUE_ID
+static bool azoteq_iqs7211e_diag_enabled = false;
+#else
+static bool azoteq_iqs7211e_diag_enabled = true;
+#endif
+static bool     azoteq_iqs7211e_diag_sweeping   = false;
+static uint8_t  azoteq_iqs7211e_diag_kind       = 0;
+static uint8_t  azoteq_iqs7211e_diag_channel    = 0;
+static uint8_t  azoteq_iqs7211e_diag_sequence   = 0;
+static uint32_t azoteq_iqs7211e_diag_sweep_time = 0;
+
+void azoteq_iqs7211e_diag_set_enabled(bool enabled) {
+    azoteq_iqs7211e_diag_enabled  = enabled;
+    azoteq_iqs7211e_diag_sweeping = false;
+#if defined(AZOTEQ_IQS7211E_PLATFORM_QMK) && !defined(AZOTEQ_IQS7211E_DIAG_RAW_HID)
+    // VIA builds leave the console quiet at init, so the heatmap turns it on
+    if (enabled) {
+        debug_enable = true;
+    }
+#endif
+}
+
+bool azoteq_iqs7211e_diag_is_enabled(void) {
+    return azoteq_iqs7211e_diag_enabled;
+}
+
+// Packet: [0] AZOTEQ_IQS7211E_DIAG_VALUE_ID, [1] sequence, [2] kind, [3] first channel, [4] channels, [5] total channels,
+// then little-endian words
+static void azoteq_iqs7211e_diag_send(uint8_t *packet, uint8_t count) {
+#ifdef AZOTEQ_IQS7211E_DIAG_RAW_HID
+    raw_hid_send(packet, AZOTEQ_IQS7211E_DIAG_PACKET_SIZE);
+#else
+    dprintf("H,%u,%u,%u", packet[1], packet[2], packet[3]);
+    for (uint8_t i = 0; i < count; i++) {
+        dprintf(",%d", (int16_t)(packet[AZOTEQ_IQS7211E_DIAG_HEADER_SIZE + i * 2] | (packet[AZOTEQ_IQS7211E_DIAG_HEADER_SIZE + i * 2 + 1] << 8)));
+    }
+    dprintf("\n");
+#endif
+}
+
+// Reads one chunk per call inside the frame's comms window, so a sweep is
+// spread over several frames and never stalls a pointer report for long
+void azoteq_iqs7211e_diag_task(void) {
+    if (!azoteq_iqs7211e_diag_enabled) {
+        return;
+    }
+
+    if (!azoteq_iqs7211e_diag_sweeping) {
+        if (azoteq_iqs7211e_elapsed_ms(azoteq_iqs7211e_diag_sweep_time) < AZOTEQ_IQS7211E_DIAG_INTERVAL_MS) {
+            return;
+        }
+        azoteq_iqs7211e_diag_sweep_time = azoteq_iqs7211e_clock_ms();
+        azoteq_iqs7211e_diag_sweeping   = true;
+        azoteq_iqs7211e_diag_kind       = 0;
+        azoteq_iqs7211e_diag_channel    = 0;
+        azoteq_iqs7211e_diag_sequence++;
+    }
+
+    uint8_t packet[AZOTEQ_IQS7211E_DIAG_PACKET_SIZE] = {0};
+    uint8_t count                                    = AZOTEQ_IQS7211E_DIAG_CHANNELS - azoteq_iqs7211e_diag_channel;
+    if (count > AZOTEQ_IQS7211E_DIAG_CHUNK) {
+        count = AZOTEQ_IQS7211E_DIAG_CHUNK;
+    }
+
+    i2c_status_t status = azoteq_iqs7211e_bus_read(azoteq_iqs7211e_diag_address[azoteq_iqs7211e_diag_kind] + azoteq_iqs7211e_diag_channel, &packet[AZOTEQ_IQS7211E_DIAG_HEADER_SIZE], count * 2);
+    if (status != I2C_STATUS_SUCCESS) {
+        AZOTEQ_IQS7211E_LOG(DIAG_READ_FAILED, 0, status);
+        azoteq_iqs7211e_diag_sweeping = false;
+        return;
+    }
+
+    packet[0] = AZOTEQ_IQS7211E_DIAG_VALUE_ID;
+    packet[1] = azoteq_iqs7211e_diag_sequence;
+    packet[2] = azoteq_iqs7211e_diag_kind;
+    packet[3] = azoteq_iqs7211e_diag_channel;
+    packet[4] = count;
+    packet[5] = AZOTEQ_IQS7211E_DIAG_CHANNELS;
+    azoteq_iqs7211e_diag_send(packet, count);
+
+    azoteq_iqs7211e_diag_channel += count;
+    if (azoteq_iqs7211e_diag_channel >= AZOTEQ_IQS7211E_DIAG_CHANNELS) {
+        azoteq_iqs7211e_diag_channel = 0;
+        if (++azoteq_iqs7211e_diag_kind >= AZOTEQ_IQS7211E_DIAG_KIND_COUNT) {
+            azoteq_iqs7211e_diag_sweeping = false;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Time between the starts of two heatmap sweeps
+#ifndef AZOTEQ_IQS7211E_DIAG_INTERVAL_MS
+#    define AZOTEQ_IQS7211E_DIAG_INTERVAL_MS 250
+#endif
+
+// Channels read per frame; 13 fills one 32 byte raw HID packet
+#ifndef AZOTEQ_IQS7211E_DIAG_CHUNK
+#    define AZOTEQ_IQS7211E_DIAG_CHUNK 13
+#endif
+
+// Value id on the custom channel: id_custom_set_value with [3] 1 starts, 0
+// stops the heatmap; id_custom_get_value returns the state in [3]. Plain raw
+// HID builds also start their unsolicited heatmap packets with this byte.
+#define AZOTEQ_IQS7211E_DIAG_VALUE_ID 0x80
+
+typedef enum {
+    AZOTEQ_IQS7211E_DIAG_COUNTS = 0,
+    AZOTEQ_IQS7211E_DIAG_DELTAS,
+    AZOTEQ_IQS7211E_DIAG_KIND_COUNT,
+} azoteq_iqs7211e_diag_kind_t;
+
+void azoteq_iqs7211e_diag_set_enabled(bool enabled);
+bool azoteq_iqs7211e_diag_is_enabled(void);
+void azoteq_iqs7211e_diag_task(void);
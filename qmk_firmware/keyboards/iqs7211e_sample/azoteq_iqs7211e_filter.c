@@ -0,0 +1,66 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_filter.h"
+#include <stdlib.h>
+
+// tau = 1 / (2 pi fc): with fc in mHz, tau in Q8 ms is this constant divided by fc
+#define AZOTEQ_IQS7211E_FILTER_TAU_Q8 40743665UL
+
+azoteq_iqs7211e_filter_params_t azoteq_iqs7211e_filter_params = {
+    .min_cutoff = AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF,
+    .beta       = AZOTEQ_IQS7211E_FILTER_BETA,
+};
+
+// Smoothing factor dt / (dt + tau) for a cutoff and frame period, Q12
+static int32_t azoteq_iqs7211e_filter_alpha(uint32_t cutoff_mhz, uint16_t dt_ms) {
+    uint32_t tau = AZOTEQ_IQS7211E_FILTER_TAU_Q8 / (cutoff_mhz ? cutoff_mhz : 1);
+    return ((uint32_t)dt_ms << 20) / (((uint32_t)dt_ms << 8) + tau);
+}
+
+static int32_t azoteq_iqs7211e_filter_axis_update(azoteq_iqs7211e_filter_axis_t *axis, uint16_t z, uint16_t dt_ms) {
+    int32_t value = (int32_t)z << 8;
+
+    // Speed estimate, low-passed with a fixed cutoff
+    int32_t speed = (((value - axis->value) >> 8) * 1000) / dt_ms;
+    int32_t alpha = azoteq_iqs7211e_filter_alpha(AZOTEQ_IQS7211E_FILTER_SPEED_CUTOFF, dt_ms);
+    axis->speed += ((speed - axis->speed) * alpha) >> 12;
+
+    // Position cutoff rises with speed: heavy smoothing at rest, little lag in motion
+    uint32_t cutoff = azoteq_iqs7211e_filter_params.min_cutoff + azoteq_iqs7211e_filter_params.beta * (uint32_t)abs(axis->speed);
+    alpha           = azoteq_iqs7211e_filter_alpha(cutoff, dt_ms);
+    axis->value += ((value - axis->value) * alpha) >> 12;
+
+    return (axis->value + 128) >> 8;
+}
+
+void azoteq_iqs7211e_filter_reset(azoteq_iqs7211e_filter_t *filter, uint16_t x, uint16_t y) {
+    filter->x.value = (int32_t)x << 8;
+    filter->x.speed = 0;
+    filter->y.value = (int32_t)y << 8;
+    filter->y.speed = 0;
+}
+
+void azoteq_iqs7211e_filter_update(azoteq_iqs7211e_filter_t *filter, uint16_t *x, uint16_t *y, uint16_t dt_ms) {
+    if (dt_ms == 0) {
+        dt_ms = 1;
+    } else if (dt_ms > 255) {
+        dt_ms = 255;
+    }
+    *x = azoteq_iqs7211e_filter_axis_update(&filter->x, *x, dt_ms);
+    *y = azoteq_iqs7211e_filter_axis_update(&filter->y, *y, dt_ms);
+}
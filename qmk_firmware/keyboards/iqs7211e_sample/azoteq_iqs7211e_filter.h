@@ -0,0 +1,57 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Cutoff at rest, in mHz; lower is smoother
+#ifndef AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF
+#    define AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF 1000
+#endif
+
+// Cutoff increase per count/s of finger speed, in mHz; higher is less lag
+#ifndef AZOTEQ_IQS7211E_FILTER_BETA
+#    define AZOTEQ_IQS7211E_FILTER_BETA 40
+#endif
+
+// Cutoff of the speed estimate, in mHz
+#ifndef AZOTEQ_IQS7211E_FILTER_SPEED_CUTOFF
+#    define AZOTEQ_IQS7211E_FILTER_SPEED_CUTOFF 1000
+#endif
+
+// Cutoff settings in use, initialised from the defines above; shared by all contacts
+typedef struct {
+    uint16_t min_cutoff; // mHz
+    uint16_t beta;       // mHz per count/s
+} azoteq_iqs7211e_filter_params_t;
+
+extern azoteq_iqs7211e_filter_params_t azoteq_iqs7211e_filter_params;
+
+typedef struct {
+    int32_t value; // filtered position, Q8 counts
+    int32_t speed; // filtered speed, counts per second
+} azoteq_iqs7211e_filter_axis_t;
+
+// One-Euro style adaptive low-pass filter, one per contact
+typedef struct {
+    azoteq_iqs7211e_filter_axis_t x;
+    azoteq_iqs7211e_filter_axis_t y;
+} azoteq_iqs7211e_filter_t;
+
+void azoteq_iqs7211e_filter_reset(azoteq_iqs7211e_filter_t *filter, uint16_t x, uint16_t y);
+void azoteq_iqs7211e_filter_update(azoteq_iqs7211e_filter_t *filter, uint16_t *x, uint16_t *y, uint16_t dt_ms);
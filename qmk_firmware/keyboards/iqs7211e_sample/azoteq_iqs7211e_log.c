@@ -0,0 +1,116 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_log.h"
+#include <string.h>
+
+#if AZOTEQ_IQS7211E_LOG_LEVEL > AZOTEQ_IQS7211E_LOG_NONE
+
+_Static_assert((AZOTEQ_IQS7211E_LOG_SIZE & (AZOTEQ_IQS7211E_LOG_SIZE - 1)) == 0 && AZOTEQ_IQS7211E_LOG_SIZE <= 128, "AZOTEQ_IQS7211E_LOG_SIZE must be a power of two up to 128");
+
+#if defined(VIA_ENABLE) || defined(RAW_ENABLE)
+// Raw HID users pull the log with AZOTEQ_IQS7211E_LOG_VALUE_ID
+#    define AZOTEQ_IQS7211E_LOG_ON_REQUEST
+#endif
+
+#define AZOTEQ_IQS7211E_LOG_HEADER_SIZE 5
+#define AZOTEQ_IQS7211E_LOG_LINE_RECORDS 4
+
+static azoteq_iqs7211e_log_record_t azoteq_iqs7211e_log_ring[AZOTEQ_IQS7211E_LOG_SIZE];
+static uint8_t                      azoteq_iqs7211e_log_head    = 0; // next write
+static uint8_t                      azoteq_iqs7211e_log_tail    = 0; // next read
+static uint8_t                      azoteq_iqs7211e_log_dropped = 0; // saturates at 255
+#ifndef AZOTEQ_IQS7211E_LOG_ON_REQUEST
+static uint32_t azoteq_iqs7211e_log_drain_time = 0;
+#endif
+
+void azoteq_iqs7211e_log_write(azoteq_iqs7211e_event_t event, uint8_t a, uint16_t b) {
+    azoteq_iqs7211e_log_record_t *record = &azoteq_iqs7211e_log_ring[azoteq_iqs7211e_log_head % AZOTEQ_IQS7211E_LOG_SIZE];
+
+    record->time  = azoteq_iqs7211e_clock_ms();
+    record->event = event;
+    record->a     = a;
+    record->b     = b;
+
+    azoteq_iqs7211e_log_head++;
+    if ((uint8_t)(azoteq_iqs7211e_log_head - azoteq_iqs7211e_log_tail) > AZOTEQ_IQS7211E_LOG_SIZE) {
+        // Full: the oldest record was just overwritten
+        azoteq_iqs7211e_log_tail++;
+        if (azoteq_iqs7211e_log_dropped < UINT8_MAX) {
+            azoteq_iqs7211e_log_dropped++;
+        }
+    }
+}
+
+// Moves up to max_records of the oldest records out of the ring; dropped
+// returns and clears the count of records lost to overflow since the last read
+uint8_t azoteq_iqs7211e_log_read(azoteq_iqs7211e_log_record_t *records, uint8_t max_records, uint8_t *dropped) {
+    uint8_t count = 0;
+
+    while (count < max_records && azoteq_iqs7211e_log_tail != azoteq_iqs7211e_log_head) {
+        records[count++] = azoteq_iqs7211e_log_ring[azoteq_iqs7211e_log_tail++ % AZOTEQ_IQS7211E_LOG_SIZE];
+    }
+
+    *dropped                    = azoteq_iqs7211e_log_dropped;
+    azoteq_iqs7211e_log_dropped = 0;
+    return count;
+}
+
+// Background drain: one console line of raw record bytes in hex per interval,
+// "L,<dropped>,<record>,<record>..."
+void azoteq_iqs7211e_log_task(void) {
+#ifndef AZOTEQ_IQS7211E_LOG_ON_REQUEST
+    if (azoteq_iqs7211e_log_tail == azoteq_iqs7211e_log_head || azoteq_iqs7211e_elapsed_ms(azoteq_iqs7211e_log_drain_time) < AZOTEQ_IQS7211E_LOG_DRAIN_MS) {
+        return;
+    }
+    azoteq_iqs7211e_log_drain_time = azoteq_iqs7211e_clock_ms();
+
+    azoteq_iqs7211e_log_record_t records[AZOTEQ_IQS7211E_LOG_LINE_RECORDS];
+    uint8_t                      dropped;
+    uint8_t                      count = azoteq_iqs7211e_log_read(records, AZOTEQ_IQS7211E_LOG_LINE_RECORDS, &dropped);
+
+    dprintf("L,%u", dropped);
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *bytes = (const uint8_t *)&records[i];
+        dprintf(",%02X%02X%02X%02X%02X%02X%02X%02X", bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7]);
+    }
+    dprintf("\n");
+#endif
+}
+
+// Response: [3] records, [4] dropped, then the records as stored
+bool azoteq_iqs7211e_log_command(uint8_t *data, uint8_t length) {
+    if (length < AZOTEQ_IQS7211E_LOG_HEADER_SIZE) {
+        return false;
+    }
+
+    uint8_t max_records = (length - AZOTEQ_IQS7211E_LOG_HEADER_SIZE) / sizeof(azoteq_iqs7211e_log_record_t);
+    uint8_t count       = 0;
+
+    while (count < max_records && azoteq_iqs7211e_log_tail != azoteq_iqs7211e_log_head) {
+        memcpy(&data[AZOTEQ_IQS7211E_LOG_HEADER_SIZE + count * sizeof(azoteq_iqs7211e_log_record_t)], &azoteq_iqs7211e_log_ring[azoteq_iqs7211e_log_tail++ % AZOTEQ_IQS7211E_LOG_SIZE], sizeof(azoteq_iqs7211e_log_record_t));
+        count++;
+    }
+
+    data[3]                     = count;
+    data[4]                     = azoteq_iqs7211e_log_dropped;
+    azoteq_iqs7211e_log_dropped = 0;
+    return true;
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Runtime events are stored as fixed-size binary records in a RAM ring and
+// decoded on the host (tools/log_decode.c), so a struggling sensor costs a
+// few stores per event instead of console formatting.
+
+#define AZOTEQ_IQS7211E_LOG_NONE 0
+#define AZOTEQ_IQS7211E_LOG_ERROR 1
+#define AZOTEQ_IQS7211E_LOG_WARN 2
+#define AZOTEQ_IQS7211E_LOG_INFO 3
+#define AZOTEQ_IQS7211E_LOG_DEBUG 4
+
+// Events above this level are compiled out
+#ifndef AZOTEQ_IQS7211E_LOG_LEVEL
+#    define AZOTEQ_IQS7211E_LOG_LEVEL AZOTEQ_IQS7211E_LOG_WARN
+#endif
+
+// Records kept in RAM, a power of two; the oldest are overwritten when full
+#ifndef AZOTEQ_IQS7211E_LOG_SIZE
+#    define AZOTEQ_IQS7211E_LOG_SIZE 32
+#endif
+
+// Minimum time between two background drains over the console
+#ifndef AZOTEQ_IQS7211E_LOG_DRAIN_MS
+#    define AZOTEQ_IQS7211E_LOG_DRAIN_MS 100
+#endif
+
+// Value id on the custom channel; id_custom_get_value returns pending records
+// in [3] count, [4] dropped, then 8 byte records from [5]
+#define AZOTEQ_IQS7211E_LOG_VALUE_ID 0x81
+
+// X(name, level, argument a, argument b); unused arguments are NULL. Append
+// only, the numbering is part of the record format.
+#define AZOTEQ_IQS7211E_LOG_EVENTS(X)                                     \
+    X(RDY_TIMEOUT, AZOTEQ_IQS7211E_LOG_WARN, NULL, "timeout_ms")          \
+    X(FRAME_NOT_READY, AZOTEQ_IQS7211E_LOG_WARN, NULL, NULL)              \
+    X(FRAME_FAILED, AZOTEQ_IQS7211E_LOG_ERROR, "status", NULL)            \
+    X(INIT_FAILED, AZOTEQ_IQS7211E_LOG_ERROR, "status", "product")        \
+    X(BUS_FALLBACK, AZOTEQ_IQS7211E_LOG_WARN, "profile", NULL)            \
+    X(REATI, AZOTEQ_IQS7211E_LOG_INFO, "status", NULL)                    \
+    X(FREQUENCY_HOP, AZOTEQ_IQS7211E_LOG_INFO, "frequency", "alp")        \
+    X(TUNABLE_WRITE_FAILED, AZOTEQ_IQS7211E_LOG_ERROR, "block", "status") \
+    X(DIAG_READ_FAILED, AZOTEQ_IQS7211E_LOG_ERROR, NULL, "status")        \
+    X(ATI_ERROR, AZOTEQ_IQS7211E_LOG_WARN, "info_flags", NULL)            \
+    X(STUCK_TOUCH, AZOTEQ_IQS7211E_LOG_INFO, NULL, NULL)
+
+typedef enum {
+#define AZOTEQ_IQS7211E_LOG_EVENT_ID(name, level, a, b) AZOTEQ_IQS7211E_EVENT_##name,
+    AZOTEQ_IQS7211E_LOG_EVENTS(AZOTEQ_IQS7211E_LOG_EVENT_ID)
+#undef AZOTEQ_IQS7211E_LOG_EVENT_ID
+    AZOTEQ_IQS7211E_EVENT_COUNT,
+} azoteq_iqs7211e_event_t;
+
+enum {
+#define AZOTEQ_IQS7211E_LOG_EVENT_LEVEL(name, level, a, b) AZOTEQ_IQS7211E_LOG_LEVEL_##name = level,
+    AZOTEQ_IQS7211E_LOG_EVENTS(AZOTEQ_IQS7211E_LOG_EVENT_LEVEL)
+#undef AZOTEQ_IQS7211E_LOG_EVENT_LEVEL
+};
+
+// Record as stored and sent, little endian
+typedef struct {
+    uint32_t time; // ms
+    uint8_t  event;
+    uint8_t  a;
+    uint16_t b;
+} azoteq_iqs7211e_log_record_t;
+
+_Static_assert(sizeof(azoteq_iqs7211e_log_record_t) == 8, "log record must stay 8 bytes");
+
+#if AZOTEQ_IQS7211E_LOG_LEVEL > AZOTEQ_IQS7211E_LOG_NONE
+#    define AZOTEQ_IQS7211E_LOG(name, a, b)                                                          \
+        do {                                                                                         \
+            if (AZOTEQ_IQS7211E_LOG_LEVEL_##name <= AZOTEQ_IQS7211E_LOG_LEVEL) {                     \
+                azoteq_iqs7211e_log_write(AZOTEQ_IQS7211E_EVENT_##name, (uint8_t)(a), (uint16_t)(b)); \
+            }                                                                                        \
+        } while (0)
+#else
+#    define AZOTEQ_IQS7211E_LOG(name, a, b) \
+        do {                                \
+            (void)(a);                      \
+            (void)(b);                      \
+        } while (0)
+#endif
+
+void    azoteq_iqs7211e_log_write(azoteq_iqs7211e_event_t event, uint8_t a, uint16_t b);
+uint8_t azoteq_iqs7211e_log_read(azoteq_iqs7211e_log_record_t *records, uint8_t max_records, uint8_t *dropped);
+void    azoteq_iqs7211e_log_task(void);
+bool    azoteq_iqs7211e_log_command(uint8_t *data, uint8_t length);
@@ -0,0 +1,94 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_noise.h"
+#include "azoteq_iqs7211e_units.h"
+#include "IQS7211_init.h"
+#include <stdlib.h>
+
+static const uint8_t azoteq_iqs7211e_noise_frequencies[]     = {AZOTEQ_IQS7211E_NOISE_FREQUENCIES};
+static const uint8_t azoteq_iqs7211e_noise_alp_frequencies[] = {AZOTEQ_IQS7211E_NOISE_ALP_FREQUENCIES};
+
+#define AZOTEQ_IQS7211E_NOISE_FREQUENCY_COUNT (sizeof(azoteq_iqs7211e_noise_frequencies) / sizeof(azoteq_iqs7211e_noise_frequencies[0]))
+
+_Static_assert(sizeof(azoteq_iqs7211e_noise_alp_frequencies) == sizeof(azoteq_iqs7211e_noise_frequencies), "AZOTEQ_IQS7211E_NOISE_ALP_FREQUENCIES needs one value per trackpad frequency");
+
+static uint8_t  azoteq_iqs7211e_noise_index   = 0;
+static uint8_t  azoteq_iqs7211e_noise_samples = 0;
+static uint8_t  azoteq_iqs7211e_noise_windows = 0;
+static uint16_t azoteq_iqs7211e_noise_start_x = 0;
+static uint16_t azoteq_iqs7211e_noise_start_y = 0;
+static uint16_t azoteq_iqs7211e_noise_last_x  = 0;
+static uint16_t azoteq_iqs7211e_noise_last_y  = 0;
+static uint16_t azoteq_iqs7211e_noise_path    = 0;
+
+// Feed one frame; returns true once noise has been sustained long enough to hop.
+// Jitter is the path length of the finger minus its net travel, measured only
+// while the finger is resting, so real motion does not count as noise. Palms
+// and extra fingers are a touch condition, not noise, and never count.
+bool azoteq_iqs7211e_noise_update(uint8_t finger_count, uint16_t x, uint16_t y) {
+    if (finger_count != 1) {
+        azoteq_iqs7211e_noise_samples = 0;
+        return false;
+    }
+
+    if (azoteq_iqs7211e_noise_samples == 0) {
+        azoteq_iqs7211e_noise_start_x = x;
+        azoteq_iqs7211e_noise_start_y = y;
+        azoteq_iqs7211e_noise_path    = 0;
+    } else {
+        azoteq_iqs7211e_noise_path += abs((int16_t)(x - azoteq_iqs7211e_noise_last_x)) + abs((int16_t)(y - azoteq_iqs7211e_noise_last_y));
+    }
+    azoteq_iqs7211e_noise_last_x = x;
+    azoteq_iqs7211e_noise_last_y = y;
+
+    if (++azoteq_iqs7211e_noise_samples < AZOTEQ_IQS7211E_NOISE_WINDOW) {
+        return false;
+    }
+    azoteq_iqs7211e_noise_samples = 0;
+
+    uint16_t travel = abs((int16_t)(x - azoteq_iqs7211e_noise_start_x)) + abs((int16_t)(y - azoteq_iqs7211e_noise_start_y));
+    if (travel >= azoteq_iqs7211e_units.noise_stationary) {
+        // Finger was moving, this window says nothing about noise
+        return false;
+    }
+
+    uint16_t jitter = ((uint32_t)(azoteq_iqs7211e_noise_path - travel) << 4) / (AZOTEQ_IQS7211E_NOISE_WINDOW - 1);
+    if (jitter > AZOTEQ_IQS7211E_NOISE_THRESHOLD) {
+        azoteq_iqs7211e_noise_windows++;
+    } else if (azoteq_iqs7211e_noise_windows > 0) {
+        azoteq_iqs7211e_noise_windows--;
+    }
+
+    return azoteq_iqs7211e_noise_windows >= AZOTEQ_IQS7211E_NOISE_SUSTAIN;
+}
+
+// Move to the next frequency pair and return the trackpad fraction value
+uint8_t azoteq_iqs7211e_noise_hop(void) {
+    azoteq_iqs7211e_noise_index   = (azoteq_iqs7211e_noise_index + 1) % AZOTEQ_IQS7211E_NOISE_FREQUENCY_COUNT;
+    azoteq_iqs7211e_noise_windows = 0;
+    azoteq_iqs7211e_noise_samples = 0;
+    return azoteq_iqs7211e_noise_frequencies[azoteq_iqs7211e_noise_index];
+}
+
+uint8_t azoteq_iqs7211e_noise_frequency(void) {
+    return azoteq_iqs7211e_noise_frequencies[azoteq_iqs7211e_noise_index];
+}
+
+uint8_t azoteq_iqs7211e_noise_alp_frequency(void) {
+    return azoteq_iqs7211e_noise_alp_frequencies[azoteq_iqs7211e_noise_index];
+}
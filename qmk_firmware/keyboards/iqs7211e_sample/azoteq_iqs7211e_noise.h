@@ -0,0 +1,57 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Single-finger frames per noise estimate
+#ifndef AZOTEQ_IQS7211E_NOISE_WINDOW
+#    define AZOTEQ_IQS7211E_NOISE_WINDOW 16
+#endif
+
+// Net travel over a window below which the finger counts as stationary
+#ifndef AZOTEQ_IQS7211E_NOISE_STATIONARY_UM
+#    define AZOTEQ_IQS7211E_NOISE_STATIONARY_UM 720
+#endif
+
+// Mean jitter per frame, in 1/16 sensor counts, above which a window is noisy
+#ifndef AZOTEQ_IQS7211E_NOISE_THRESHOLD
+#    define AZOTEQ_IQS7211E_NOISE_THRESHOLD 48
+#endif
+
+// Consecutive noisy windows before switching frequency
+#ifndef AZOTEQ_IQS7211E_NOISE_SUSTAIN
+#    define AZOTEQ_IQS7211E_NOISE_SUSTAIN 3
+#endif
+
+// Trackpad conversion frequency fraction values to hop between; the first is the configured one
+#ifndef AZOTEQ_IQS7211E_NOISE_FREQUENCIES
+#    define AZOTEQ_IQS7211E_NOISE_FREQUENCIES TP_CONVERSION_FREQUENCY_FRACTION_VALUE, 0x14, 0x22, 0x2C
+#endif
+
+// ALP conversion frequency fraction values, one per trackpad frequency; the
+// ALP channel sees the same interference and hops along with the trackpad
+#ifndef AZOTEQ_IQS7211E_NOISE_ALP_FREQUENCIES
+#    define AZOTEQ_IQS7211E_NOISE_ALP_FREQUENCIES ALP_CONVERSION_FREQUENCY_FRACTION_VALUE, 0x14, 0x22, 0x2C
+#endif
+
+bool    azoteq_iqs7211e_noise_update(uint8_t finger_count, uint16_t x, uint16_t y);
+uint8_t azoteq_iqs7211e_noise_hop(void);
+uint8_t azoteq_iqs7211e_noise_frequency(void);
+uint8_t azoteq_iqs7211e_noise_alp_frequency(void);
@@ -0,0 +1,158 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_pinch.h"
+#include "azoteq_iqs7211e_rim.h"
+#include "azoteq_iqs7211e_transform.h"
+#include "azoteq_iqs7211e_units.h"
+#include <stdlib.h>
+
+uint16_t azoteq_iqs7211e_isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit  = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Distance and angle of the second contact as seen from the first
+static void azoteq_iqs7211e_pinch_geometry(const azoteq_iqs7211e_tracker_t *tracker, uint16_t *distance, uint16_t *angle) {
+    int16_t dx = (int16_t)(tracker->contact[1].x - tracker->contact[0].x);
+    int16_t dy = (int16_t)(tracker->contact[1].y - tracker->contact[0].y);
+
+    *distance = azoteq_iqs7211e_isqrt((int32_t)dx * dx + (int32_t)dy * dy);
+    *angle    = azoteq_iqs7211e_atan2(dy, dx);
+}
+
+static int16_t azoteq_iqs7211e_angle_diff(uint16_t to, uint16_t from) {
+    int16_t diff = (int16_t)((to - from) & (AZOTEQ_IQS7211E_ANGLE_TURN - 1));
+    if (diff >= AZOTEQ_IQS7211E_ANGLE_TURN / 2) {
+        diff -= AZOTEQ_IQS7211E_ANGLE_TURN;
+    }
+    return diff;
+}
+
+static void azoteq_iqs7211e_pinch_mods(azoteq_iqs7211e_pinch_t *pinch) {
+    if (!pinch->mods_held) {
+        azoteq_iqs7211e_hold_ctrl(true);
+        pinch->mods_held = true;
+    }
+}
+
+// Fingers spreading apart (positive steps) zoom in
+static void azoteq_iqs7211e_pinch_emit(azoteq_iqs7211e_pinch_t *pinch, int16_t steps, azoteq_iqs7211e_motion_t *motion) {
+#if defined(AZOTEQ_IQS7211E_ZOOM_IN_KEYCODE) && defined(AZOTEQ_IQS7211E_ZOOM_OUT_KEYCODE)
+    for (; steps > 0; steps--) {
+        azoteq_iqs7211e_tap_keycode(AZOTEQ_IQS7211E_ZOOM_IN_KEYCODE);
+    }
+    for (; steps < 0; steps++) {
+        azoteq_iqs7211e_tap_keycode(AZOTEQ_IQS7211E_ZOOM_OUT_KEYCODE);
+    }
+#else
+    azoteq_iqs7211e_pinch_mods(pinch);
+    motion->v = steps;
+#endif
+}
+
+// Clockwise for positive steps
+static void azoteq_iqs7211e_rotate_emit(azoteq_iqs7211e_pinch_t *pinch, int16_t steps, azoteq_iqs7211e_motion_t *motion) {
+#if defined(AZOTEQ_IQS7211E_ROTATE_CW_KEYCODE) && defined(AZOTEQ_IQS7211E_ROTATE_CCW_KEYCODE)
+    for (; steps > 0; steps--) {
+        azoteq_iqs7211e_tap_keycode(AZOTEQ_IQS7211E_ROTATE_CW_KEYCODE);
+    }
+    for (; steps < 0; steps++) {
+        azoteq_iqs7211e_tap_keycode(AZOTEQ_IQS7211E_ROTATE_CCW_KEYCODE);
+    }
+#else
+    azoteq_iqs7211e_pinch_mods(pinch);
+    motion->h = steps;
+#endif
+}
+
+void azoteq_iqs7211e_pinch_start(azoteq_iqs7211e_pinch_t *pinch, const azoteq_iqs7211e_tracker_t *tracker) {
+    azoteq_iqs7211e_pinch_end(pinch);
+    azoteq_iqs7211e_pinch_geometry(tracker, &pinch->start_distance, &pinch->start_angle);
+    pinch->distance      = pinch->start_distance;
+    pinch->angle         = pinch->start_angle;
+    pinch->scroll_travel = 0;
+    pinch->mode          = AZOTEQ_IQS7211E_TWO_FINGER_UNDECIDED;
+}
+
+// Returns true if the caller should scroll with this frame's motion
+bool azoteq_iqs7211e_pinch_update(azoteq_iqs7211e_pinch_t *pinch, const azoteq_iqs7211e_tracker_t *tracker, int16_t scroll_x, int16_t scroll_y, azoteq_iqs7211e_motion_t *motion) {
+    uint16_t distance, angle;
+    azoteq_iqs7211e_pinch_geometry(tracker, &distance, &angle);
+
+    if (pinch->mode == AZOTEQ_IQS7211E_TWO_FINGER_UNDECIDED) {
+        // Whichever motion passes its threshold first owns the touch until a finger lifts
+        uint16_t spread = abs((int16_t)(distance - pinch->start_distance));
+        uint16_t arc    = ((uint32_t)abs(azoteq_iqs7211e_angle_diff(angle, pinch->start_angle)) * distance * 201) >> 15; // 2*pi/1024 ~= 201/32768
+
+        pinch->scroll_travel += abs(scroll_x) + abs(scroll_y);
+
+        if (spread >= azoteq_iqs7211e_units.pinch_lock && spread >= arc) {
+            pinch->mode = AZOTEQ_IQS7211E_TWO_FINGER_PINCH;
+        } else if (arc >= azoteq_iqs7211e_units.rotate_lock) {
+            pinch->mode = AZOTEQ_IQS7211E_TWO_FINGER_ROTATE;
+        } else if (pinch->scroll_travel >= azoteq_iqs7211e_units.scroll_lock && pinch->scroll_travel >= spread + arc) {
+            pinch->mode = AZOTEQ_IQS7211E_TWO_FINGER_SCROLL;
+        }
+    }
+
+    switch (pinch->mode) {
+        case AZOTEQ_IQS7211E_TWO_FINGER_SCROLL:
+            return true;
+        case AZOTEQ_IQS7211E_TWO_FINGER_PINCH: {
+            int16_t steps = (int16_t)(distance - pinch->distance) / (int16_t)azoteq_iqs7211e_units.pinch_step;
+            if (steps != 0) {
+                pinch->distance += steps * azoteq_iqs7211e_units.pinch_step;
+                azoteq_iqs7211e_pinch_emit(pinch, steps, motion);
+            }
+            break;
+        }
+        case AZOTEQ_IQS7211E_TWO_FINGER_ROTATE: {
+            int16_t steps = azoteq_iqs7211e_angle_diff(angle, pinch->angle) / AZOTEQ_IQS7211E_ROTATE_STEP;
+            if (steps != 0) {
+                pinch->angle += steps * AZOTEQ_IQS7211E_ROTATE_STEP;
+                azoteq_iqs7211e_rotate_emit(pinch, steps * AZOTEQ_IQS7211E_TRANSFORM_HANDEDNESS, motion);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
+void azoteq_iqs7211e_pinch_end(azoteq_iqs7211e_pinch_t *pinch) {
+    if (pinch->mods_held) {
+        azoteq_iqs7211e_hold_ctrl(false);
+        pinch->mods_held = false;
+    }
+    pinch->mode = AZOTEQ_IQS7211E_TWO_FINGER_UNDECIDED;
+}
@@ -0,0 +1,74 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_tracker.h"
+
+// Mean finger travel that locks a two-finger touch into scrolling
+#ifndef AZOTEQ_IQS7211E_SCROLL_LOCK_UM
+#    define AZOTEQ_IQS7211E_SCROLL_LOCK_UM 720
+#endif
+
+// Change of finger distance that locks into pinch
+#ifndef AZOTEQ_IQS7211E_PINCH_LOCK_UM
+#    define AZOTEQ_IQS7211E_PINCH_LOCK_UM 1440
+#endif
+
+// Arc travelled by the fingers that locks into rotate
+#ifndef AZOTEQ_IQS7211E_ROTATE_LOCK_UM
+#    define AZOTEQ_IQS7211E_ROTATE_LOCK_UM 1440
+#endif
+
+// Distance change per zoom step once pinching
+#ifndef AZOTEQ_IQS7211E_PINCH_STEP_UM
+#    define AZOTEQ_IQS7211E_PINCH_STEP_UM 960
+#endif
+
+// Angle per rotate step once rotating, in 1/1024 turns
+#ifndef AZOTEQ_IQS7211E_ROTATE_STEP
+#    define AZOTEQ_IQS7211E_ROTATE_STEP 16
+#endif
+
+// Without keycodes, pinch sends Ctrl+wheel and rotate sends Ctrl+horizontal wheel.
+// Define AZOTEQ_IQS7211E_ZOOM_IN_KEYCODE / _ZOOM_OUT_ and AZOTEQ_IQS7211E_ROTATE_CW_KEYCODE / _CCW_
+// to tap keycodes instead, e.g. LCTL(KC_EQUAL) and LCTL(KC_MINUS).
+
+typedef enum {
+    AZOTEQ_IQS7211E_TWO_FINGER_UNDECIDED = 0,
+    AZOTEQ_IQS7211E_TWO_FINGER_SCROLL,
+    AZOTEQ_IQS7211E_TWO_FINGER_PINCH,
+    AZOTEQ_IQS7211E_TWO_FINGER_ROTATE,
+} azoteq_iqs7211e_two_finger_mode_t;
+
+typedef struct {
+    azoteq_iqs7211e_two_finger_mode_t mode;
+    uint16_t                          start_distance;
+    uint16_t                          start_angle;
+    uint16_t                          distance; // at the last emitted step
+    uint16_t                          angle;
+    uint16_t                          scroll_travel;
+    bool                              mods_held;
+} azoteq_iqs7211e_pinch_t;
+
+uint16_t azoteq_iqs7211e_isqrt(uint32_t value);
+void     azoteq_iqs7211e_pinch_start(azoteq_iqs7211e_pinch_t *pinch, const azoteq_iqs7211e_tracker_t *tracker);
+bool     azoteq_iqs7211e_pinch_update(azoteq_iqs7211e_pinch_t *pinch, const azoteq_iqs7211e_tracker_t *tracker, int16_t scroll_x, int16_t scroll_y, azoteq_iqs7211e_motion_t *motion);
+void     azoteq_iqs7211e_pinch_end(azoteq_iqs7211e_pinch_t *pinch);
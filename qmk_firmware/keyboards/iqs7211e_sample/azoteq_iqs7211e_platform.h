@@ -0,0 +1,66 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Bus, GPIO and clock interface of the IQS7211E core. The core never calls a
+// platform API directly; each adapter header provides, as inline functions:
+//
+//   void         azoteq_iqs7211e_bus_init(void);
+//   i2c_status_t azoteq_iqs7211e_bus_read(uint8_t reg, uint8_t *data, uint16_t length);
+//   i2c_status_t azoteq_iqs7211e_bus_write(uint8_t reg, const uint8_t *data, uint16_t length);
+//   bool         azoteq_iqs7211e_bus_set_clock(uint32_t hz);    unless AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+//   bool         azoteq_iqs7211e_rdy_init(void);                false without a RDY line
+//   bool         azoteq_iqs7211e_rdy_asserted(void);
+//   void         azoteq_iqs7211e_delay_ms(uint16_t ms);
+//   uint32_t     azoteq_iqs7211e_clock_ms(void);
+//   uint32_t     azoteq_iqs7211e_clock_us(void);                 free running, wraps at 2^32 us
+//   uint32_t     azoteq_iqs7211e_typing_elapsed_ms(void);        time since the last key event
+//   void         azoteq_iqs7211e_hold_ctrl(bool held);           only with AZOTEQ_IQS7211E_PINCH_ENABLE
+//   void         azoteq_iqs7211e_tap_keycode(uint16_t keycode);
+//   bool         azoteq_iqs7211e_storage_read(uint8_t *data);    AZOTEQ_IQS7211E_STORAGE_SIZE bytes
+//   void         azoteq_iqs7211e_storage_write(const uint8_t *data);
+//
+// plus dprintf() and i2c_status_t with the I2C_STATUS_* values, which the
+// core keeps from its QMK origin, and AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION,
+// the step of clock_us in us. Adapters that cannot change the bus clock
+// define AZOTEQ_IQS7211E_BUS_CLOCK_FIXED and AZOTEQ_IQS7211E_BUS_PROFILE to
+// the clock the board runs at. bus_read and bus_write report every
+// transaction with AZOTEQ_IQS7211E_COUNT_TRANSFER(length).
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Adapters call this once per bus transaction, with the payload length
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+void azoteq_iqs7211e_power_count_transfer(uint16_t length);
+#    define AZOTEQ_IQS7211E_COUNT_TRANSFER(length) azoteq_iqs7211e_power_count_transfer(length)
+#else
+#    define AZOTEQ_IQS7211E_COUNT_TRANSFER(length)
+#endif
+
+#if defined(__ZEPHYR__)
+#    include "azoteq_iqs7211e_platform_zmk.h"
+#elif defined(AZOTEQ_IQS7211E_PLATFORM_HOST)
+#    include "azoteq_iqs7211e_platform_host.h"
+#else
+#    include "azoteq_iqs7211e_platform_qmk.h"
+#endif
+
+static inline uint32_t azoteq_iqs7211e_elapsed_ms(uint32_t since) {
+    return azoteq_iqs7211e_clock_ms() - since;
+}
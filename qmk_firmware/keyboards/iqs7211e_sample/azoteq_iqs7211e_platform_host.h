@@ -0,0 +1,100 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Host adapter of the IQS7211E core, for benchmarks and trace replay on Linux.
+// The host program implements the bus functions, usually as a simulated
+// sensor, and drives the clock through azoteq_iqs7211e_host_time_us.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int16_t i2c_status_t;
+#define I2C_STATUS_SUCCESS (0)
+#define I2C_STATUS_ERROR (-1)
+#define I2C_STATUS_TIMEOUT (-2)
+
+#ifdef AZOTEQ_IQS7211E_HOST_VERBOSE
+#    define dprintf(...) fprintf(stderr, __VA_ARGS__)
+#else
+// Arguments stay referenced so debug-only locals do not warn
+#    define dprintf(...)                         \
+        do {                                     \
+            if (0) fprintf(stderr, __VA_ARGS__); \
+        } while (0)
+#endif
+
+#define AZOTEQ_IQS7211E_STORAGE_SIZE 64
+#define AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION 1
+
+extern uint32_t azoteq_iqs7211e_host_time_us;
+
+i2c_status_t azoteq_iqs7211e_host_bus_read(uint8_t reg, uint8_t *data, uint16_t length);
+i2c_status_t azoteq_iqs7211e_host_bus_write(uint8_t reg, const uint8_t *data, uint16_t length);
+
+static inline void azoteq_iqs7211e_bus_init(void) {}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_read(uint8_t reg, uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return azoteq_iqs7211e_host_bus_read(reg, data, length);
+}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_write(uint8_t reg, const uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return azoteq_iqs7211e_host_bus_write(reg, data, length);
+}
+
+static inline bool azoteq_iqs7211e_bus_set_clock(uint32_t hz) {
+    return true;
+}
+
+// No RDY line: every call finds a frame
+static inline bool azoteq_iqs7211e_rdy_init(void) {
+    return false;
+}
+
+static inline bool azoteq_iqs7211e_rdy_asserted(void) {
+    return true;
+}
+
+static inline void azoteq_iqs7211e_delay_ms(uint16_t ms) {
+    azoteq_iqs7211e_host_time_us += ms * 1000UL;
+}
+
+static inline uint32_t azoteq_iqs7211e_clock_ms(void) {
+    return azoteq_iqs7211e_host_time_us / 1000;
+}
+
+static inline uint32_t azoteq_iqs7211e_clock_us(void) {
+    return azoteq_iqs7211e_host_time_us;
+}
+
+static inline uint32_t azoteq_iqs7211e_typing_elapsed_ms(void) {
+    return UINT32_MAX;
+}
+
+static inline void azoteq_iqs7211e_hold_ctrl(bool held) {}
+
+static inline void azoteq_iqs7211e_tap_keycode(uint16_t keycode) {}
+
+static inline bool azoteq_iqs7211e_storage_read(uint8_t *data) {
+    return false;
+}
+
+static inline void azoteq_iqs7211e_storage_write(const uint8_t *data) {}
@@ -0,0 +1,161 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// QMK adapter of the IQS7211E core
+
+#include "quantum.h"
+#include "i2c_master.h"
+
+#ifdef PROTOCOL_CHIBIOS
+#    include <hal.h>
+#endif
+
+#define AZOTEQ_IQS7211E_PLATFORM_QMK
+
+#ifndef AZOTEQ_IQS7211E_ADDRESS
+#    define AZOTEQ_IQS7211E_ADDRESS (0x56 << 1)
+#endif
+
+#ifndef AZOTEQ_IQS7211E_TIMEOUT_MS
+#    define AZOTEQ_IQS7211E_TIMEOUT_MS 100
+#endif
+
+#ifndef AZOTEQ_IQS7211E_RDY_PIN
+#    define AZOTEQ_IQS7211E_RDY_PIN 21
+#endif
+
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+// Implemented in azoteq_iqs7211e_split.c; the peripheral forwards key output to the master
+void azoteq_iqs7211e_split_hold_ctrl(bool held);
+void azoteq_iqs7211e_split_tap_keycode(uint16_t keycode);
+#endif
+
+// Tunables live in the keyboard datablock of the EEPROM
+#define AZOTEQ_IQS7211E_STORAGE_SIZE EECONFIG_KB_DATA_SIZE
+
+// Only the RP2040 timer counts microseconds; elsewhere clock_us steps in ms
+#if defined(MCU_RP)
+#    define AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION 1
+#else
+#    define AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION 1000
+#endif
+
+// QMK's I2C driver starts the peripheral with its own static configuration on
+// every transfer, so the bus clock is fixed by the board (I2C1_CLOCK_SPEED on
+// ChibiOS, F_SCL on AVR) and the bus profile only names it
+#define AZOTEQ_IQS7211E_BUS_CLOCK_FIXED
+
+#ifndef AZOTEQ_IQS7211E_BUS_PROFILE
+#    if defined(PROTOCOL_CHIBIOS) && defined(I2C1_CLOCK_SPEED)
+#        define AZOTEQ_IQS7211E_QMK_BUS_HZ I2C1_CLOCK_SPEED
+#    elif defined(PROTOCOL_CHIBIOS)
+#        define AZOTEQ_IQS7211E_QMK_BUS_HZ 100000
+#    elif defined(F_SCL)
+#        define AZOTEQ_IQS7211E_QMK_BUS_HZ F_SCL
+#    else
+#        define AZOTEQ_IQS7211E_QMK_BUS_HZ 400000
+#    endif
+#    if AZOTEQ_IQS7211E_QMK_BUS_HZ >= 1000000
+#        define AZOTEQ_IQS7211E_BUS_PROFILE AZOTEQ_IQS7211E_BUS_FAST_PLUS
+#    elif AZOTEQ_IQS7211E_QMK_BUS_HZ >= 400000
+#        define AZOTEQ_IQS7211E_BUS_PROFILE AZOTEQ_IQS7211E_BUS_FAST
+#    else
+#        define AZOTEQ_IQS7211E_BUS_PROFILE AZOTEQ_IQS7211E_BUS_STANDARD
+#    endif
+#endif
+
+static inline void azoteq_iqs7211e_bus_init(void) {
+    i2c_init();
+}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_read(uint8_t reg, uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return i2c_read_register(AZOTEQ_IQS7211E_ADDRESS, reg, data, length, AZOTEQ_IQS7211E_TIMEOUT_MS);
+}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_write(uint8_t reg, const uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return i2c_write_register(AZOTEQ_IQS7211E_ADDRESS, reg, data, length, AZOTEQ_IQS7211E_TIMEOUT_MS);
+}
+
+static inline bool azoteq_iqs7211e_rdy_init(void) {
+    if (AZOTEQ_IQS7211E_RDY_PIN == NO_PIN) {
+        return false;
+    }
+    setPinInputHigh(AZOTEQ_IQS7211E_RDY_PIN);
+    return true;
+}
+
+// RDY is active low
+static inline bool azoteq_iqs7211e_rdy_asserted(void) {
+    return !readPin(AZOTEQ_IQS7211E_RDY_PIN);
+}
+
+static inline void azoteq_iqs7211e_delay_ms(uint16_t ms) {
+    wait_ms(ms);
+}
+
+static inline uint32_t azoteq_iqs7211e_clock_ms(void) {
+    return timer_read32();
+}
+
+static inline uint32_t azoteq_iqs7211e_clock_us(void) {
+#if defined(MCU_RP)
+    return TIMER->TIMERAWL;
+#else
+    return timer_read32() * 1000;
+#endif
+}
+
+static inline uint32_t azoteq_iqs7211e_typing_elapsed_ms(void) {
+    return last_matrix_activity_elapsed();
+}
+
+static inline void azoteq_iqs7211e_hold_ctrl(bool held) {
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+    if (!is_keyboard_master()) {
+        azoteq_iqs7211e_split_hold_ctrl(held);
+        return;
+    }
+#endif
+    if (held) {
+        register_mods(MOD_BIT(KC_LCTL));
+    } else {
+        unregister_mods(MOD_BIT(KC_LCTL));
+    }
+}
+
+static inline void azoteq_iqs7211e_tap_keycode(uint16_t keycode) {
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+    if (!is_keyboard_master()) {
+        azoteq_iqs7211e_split_tap_keycode(keycode);
+        return;
+    }
+#endif
+    tap_code16(keycode);
+}
+
+static inline bool azoteq_iqs7211e_storage_read(uint8_t *data) {
+    eeconfig_read_kb_datablock(data);
+    return true;
+}
+
+static inline void azoteq_iqs7211e_storage_write(const uint8_t *data) {
+    eeconfig_update_kb_datablock(data);
+}
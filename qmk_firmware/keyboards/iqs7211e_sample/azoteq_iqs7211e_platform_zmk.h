@@ -0,0 +1,118 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Zephyr / ZMK adapter of the IQS7211E core. azoteq_iqs7211e_zmk.c points
+// azoteq_iqs7211e_zmk_i2c and azoteq_iqs7211e_zmk_rdy at its devicetree specs
+// before calling azoteq_iqs7211e_init().
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/printk.h>
+
+#define AZOTEQ_IQS7211E_PLATFORM_ZMK
+
+typedef int16_t i2c_status_t;
+#define I2C_STATUS_SUCCESS (0)
+#define I2C_STATUS_ERROR (-1)
+#define I2C_STATUS_TIMEOUT (-2)
+
+#ifdef CONFIG_ZMK_INPUT_IQS7211E_LOG
+#    define dprintf(...) printk(__VA_ARGS__)
+#else
+#    define dprintf(...)                \
+        do {                            \
+            if (0) printk(__VA_ARGS__); \
+        } while (0)
+#endif
+
+// Tunables are not persisted on ZMK; the init defaults are used
+#define AZOTEQ_IQS7211E_STORAGE_SIZE 64
+
+// clock_us counts kernel ticks, rounded up to whole us
+#define AZOTEQ_IQS7211E_CLOCK_US_RESOLUTION ((1000000 + CONFIG_SYS_CLOCK_TICKS_PER_SEC - 1) / CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+
+// Pinch zoom and rotate tap QMK keycodes, and a ZMK input device only reports
+// pointer events, so the gesture has nothing to send here
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+#    error "AZOTEQ_IQS7211E_PINCH_ENABLE is not supported on ZMK"
+#endif
+
+extern const struct i2c_dt_spec  *azoteq_iqs7211e_zmk_i2c;
+extern const struct gpio_dt_spec *azoteq_iqs7211e_zmk_rdy;
+
+static inline void azoteq_iqs7211e_bus_init(void) {}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_read(uint8_t reg, uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return i2c_burst_read_dt(azoteq_iqs7211e_zmk_i2c, reg, data, length) == 0 ? I2C_STATUS_SUCCESS : I2C_STATUS_ERROR;
+}
+
+static inline i2c_status_t azoteq_iqs7211e_bus_write(uint8_t reg, const uint8_t *data, uint16_t length) {
+    AZOTEQ_IQS7211E_COUNT_TRANSFER(length);
+    return i2c_burst_write_dt(azoteq_iqs7211e_zmk_i2c, reg, data, length) == 0 ? I2C_STATUS_SUCCESS : I2C_STATUS_ERROR;
+}
+
+static inline bool azoteq_iqs7211e_bus_set_clock(uint32_t hz) {
+    uint32_t speed;
+    if (hz >= 1000000) {
+        speed = I2C_SPEED_FAST_PLUS;
+    } else if (hz >= 400000) {
+        speed = I2C_SPEED_FAST;
+    } else {
+        speed = I2C_SPEED_STANDARD;
+    }
+    return i2c_configure(azoteq_iqs7211e_zmk_i2c->bus, I2C_MODE_CONTROLLER | I2C_SPEED_SET(speed)) == 0;
+}
+
+static inline bool azoteq_iqs7211e_rdy_init(void) {
+    if (azoteq_iqs7211e_zmk_rdy == NULL || !gpio_is_ready_dt(azoteq_iqs7211e_zmk_rdy)) {
+        return false;
+    }
+    return gpio_pin_configure_dt(azoteq_iqs7211e_zmk_rdy, GPIO_INPUT) == 0;
+}
+
+// The devicetree flags carry the active-low polarity
+static inline bool azoteq_iqs7211e_rdy_asserted(void) {
+    return gpio_pin_get_dt(azoteq_iqs7211e_zmk_rdy) > 0;
+}
+
+static inline void azoteq_iqs7211e_delay_ms(uint16_t ms) {
+    k_msleep(ms);
+}
+
+static inline uint32_t azoteq_iqs7211e_clock_ms(void) {
+    return k_uptime_get_32();
+}
+
+// The cycle counter wraps within seconds on fast cores; uptime ticks wrap at 2^32 us like the contract
+static inline uint32_t azoteq_iqs7211e_clock_us(void) {
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+// ZMK handles typing suppression in its own input processors
+static inline uint32_t azoteq_iqs7211e_typing_elapsed_ms(void) {
+    return UINT32_MAX;
+}
+
+static inline bool azoteq_iqs7211e_storage_read(uint8_t *data) {
+    return false;
+}
+
+static inline void azoteq_iqs7211e_storage_write(const uint8_t *data) {}
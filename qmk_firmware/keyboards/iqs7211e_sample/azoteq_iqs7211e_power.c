@@ -0,0 +1,168 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_power.h"
+#include "azoteq_iqs7211e_tunables.h"
+#include <string.h>
+
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+
+static const uint16_t azoteq_iqs7211e_power_cost_ua[AZOTEQ_IQS7211E_POWER_MODE_COUNT] = {
+    [AZOTEQ_IQS7211E_POWER_ACTIVE]     = AZOTEQ_IQS7211E_POWER_ACTIVE_UA,
+    [AZOTEQ_IQS7211E_POWER_IDLE_TOUCH] = AZOTEQ_IQS7211E_POWER_IDLE_TOUCH_UA,
+    [AZOTEQ_IQS7211E_POWER_IDLE]       = AZOTEQ_IQS7211E_POWER_IDLE_UA,
+    [AZOTEQ_IQS7211E_POWER_LP1]        = AZOTEQ_IQS7211E_POWER_LP1_UA,
+    [AZOTEQ_IQS7211E_POWER_LP2]        = AZOTEQ_IQS7211E_POWER_LP2_UA,
+};
+
+// Mode the sensor drops to when the timeout of a mode runs out
+static const uint8_t azoteq_iqs7211e_power_next_mode[AZOTEQ_IQS7211E_POWER_MODE_COUNT] = {
+    [AZOTEQ_IQS7211E_POWER_ACTIVE]     = AZOTEQ_IQS7211E_POWER_IDLE,
+    [AZOTEQ_IQS7211E_POWER_IDLE_TOUCH] = AZOTEQ_IQS7211E_POWER_IDLE,
+    [AZOTEQ_IQS7211E_POWER_IDLE]       = AZOTEQ_IQS7211E_POWER_LP1,
+    [AZOTEQ_IQS7211E_POWER_LP1]        = AZOTEQ_IQS7211E_POWER_LP2,
+    [AZOTEQ_IQS7211E_POWER_LP2]        = AZOTEQ_IQS7211E_POWER_LP2,
+};
+
+static azoteq_iqs7211e_power_stats_t azoteq_iqs7211e_power_stats   = {0};
+static uint32_t                      azoteq_iqs7211e_power_since   = 0;
+static bool                          azoteq_iqs7211e_power_started = false;
+
+// Configured mode timeouts, in seconds; LP2 is the last mode and never times out
+static uint32_t azoteq_iqs7211e_power_timeout_ms(uint8_t mode) {
+    switch (mode) {
+        case AZOTEQ_IQS7211E_POWER_ACTIVE:
+            return azoteq_iqs7211e_tunables_get(AZOTEQ_IQS7211E_TUNABLE_ACTIVE_MODE_TIMEOUT) * 1000UL;
+        case AZOTEQ_IQS7211E_POWER_IDLE_TOUCH:
+            return azoteq_iqs7211e_tunables_get(AZOTEQ_IQS7211E_TUNABLE_IDLE_TOUCH_MODE_TIMEOUT) * 1000UL;
+        case AZOTEQ_IQS7211E_POWER_IDLE:
+            return azoteq_iqs7211e_tunables_get(AZOTEQ_IQS7211E_TUNABLE_IDLE_MODE_TIMEOUT) * 1000UL;
+        case AZOTEQ_IQS7211E_POWER_LP1:
+            return azoteq_iqs7211e_tunables_get(AZOTEQ_IQS7211E_TUNABLE_LP1_MODE_TIMEOUT) * 1000UL;
+        default:
+            return UINT32_MAX;
+    }
+}
+
+// In event mode the sensor stays silent while nothing changes, but still
+// steps down ACTIVE -> IDLE -> LP1 -> LP2 as its mode timeouts run out. Split
+// the time since the last frame along that chain, leaving stats->mode at the
+// mode the sensor should be in by now.
+static void azoteq_iqs7211e_power_accumulate(azoteq_iqs7211e_power_stats_t *stats) {
+    if (!azoteq_iqs7211e_power_started) {
+        return;
+    }
+
+    uint32_t elapsed_ms = azoteq_iqs7211e_elapsed_ms(azoteq_iqs7211e_power_since);
+    uint32_t timeout_ms = azoteq_iqs7211e_power_timeout_ms(stats->mode);
+
+    while (elapsed_ms > timeout_ms) {
+        stats->residency_ms[stats->mode] += timeout_ms;
+        elapsed_ms -= timeout_ms;
+        stats->mode = azoteq_iqs7211e_power_next_mode[stats->mode];
+        stats->mode_changes++;
+        timeout_ms = azoteq_iqs7211e_power_timeout_ms(stats->mode);
+    }
+    stats->residency_ms[stats->mode] += elapsed_ms;
+}
+
+// Feed the first info flags byte of every frame
+void azoteq_iqs7211e_power_update(uint8_t info_flags) {
+    uint8_t mode = info_flags & IQS7211E_CHARGING_MODE_MASK;
+
+    azoteq_iqs7211e_power_accumulate(&azoteq_iqs7211e_power_stats);
+    azoteq_iqs7211e_power_since   = azoteq_iqs7211e_clock_ms();
+    azoteq_iqs7211e_power_started = true;
+
+    // Reserved encodings keep the previous mode
+    if (mode < AZOTEQ_IQS7211E_POWER_MODE_COUNT && mode != azoteq_iqs7211e_power_stats.mode) {
+        azoteq_iqs7211e_power_stats.mode = mode;
+        azoteq_iqs7211e_power_stats.mode_changes++;
+    }
+}
+
+void azoteq_iqs7211e_power_count_transfer(uint16_t length) {
+    azoteq_iqs7211e_power_stats.transfers++;
+    azoteq_iqs7211e_power_stats.transfer_bytes += length;
+}
+
+void azoteq_iqs7211e_power_count_wake(void) {
+    azoteq_iqs7211e_power_stats.wakes++;
+}
+
+void azoteq_iqs7211e_power_get_stats(azoteq_iqs7211e_power_stats_t *stats) {
+    *stats = azoteq_iqs7211e_power_stats;
+    azoteq_iqs7211e_power_accumulate(stats);
+
+    uint64_t charge_nc = (uint64_t)stats->transfers * AZOTEQ_IQS7211E_POWER_TRANSFER_NC + (uint64_t)stats->transfer_bytes * AZOTEQ_IQS7211E_POWER_BYTE_NC + (uint64_t)stats->wakes * AZOTEQ_IQS7211E_POWER_WAKE_NC;
+    uint32_t total_ms  = 0;
+    for (uint8_t mode = 0; mode < AZOTEQ_IQS7211E_POWER_MODE_COUNT; mode++) {
+        charge_nc += (uint64_t)stats->residency_ms[mode] * azoteq_iqs7211e_power_cost_ua[mode];
+        total_ms += stats->residency_ms[mode];
+    }
+
+    stats->average_ua = 0;
+    if (total_ms > 0) {
+        uint64_t average_ua = charge_nc / total_ms;
+        stats->average_ua   = average_ua > UINT16_MAX ? UINT16_MAX : average_ua;
+    }
+}
+
+// Counting restarts from the current mode
+void azoteq_iqs7211e_power_reset_stats(void) {
+    azoteq_iqs7211e_power_accumulate(&azoteq_iqs7211e_power_stats);
+
+    uint8_t mode = azoteq_iqs7211e_power_stats.mode;
+
+    azoteq_iqs7211e_power_stats      = (azoteq_iqs7211e_power_stats_t){0};
+    azoteq_iqs7211e_power_stats.mode = mode;
+    azoteq_iqs7211e_power_since      = azoteq_iqs7211e_clock_ms();
+}
+
+// [3] page: 0 residency, 1 counters. Multi-byte values in MCU byte order.
+// Page 0: [4] mode, [5] average uA, [7] residency ms per mode
+// Page 1: [4] mode, [5] transfers, [9] transfer bytes, [13] wakes, [17] mode changes
+bool azoteq_iqs7211e_power_command(uint8_t *data, uint8_t length) {
+    azoteq_iqs7211e_power_stats_t stats;
+
+    if (length < 7 + sizeof(stats.residency_ms)) {
+        return false;
+    }
+
+    switch (data[3]) {
+        case 0:
+            azoteq_iqs7211e_power_get_stats(&stats);
+            data[4] = stats.mode;
+            memcpy(&data[5], &stats.average_ua, sizeof(stats.average_ua));
+            memcpy(&data[7], stats.residency_ms, sizeof(stats.residency_ms));
+            return true;
+        case 1:
+            azoteq_iqs7211e_power_get_stats(&stats);
+            data[4] = stats.mode;
+            memcpy(&data[5], &stats.transfers, sizeof(stats.transfers));
+            memcpy(&data[9], &stats.transfer_bytes, sizeof(stats.transfer_bytes));
+            memcpy(&data[13], &stats.wakes, sizeof(stats.wakes));
+            memcpy(&data[17], &stats.mode_changes, sizeof(stats.mode_changes));
+            return true;
+        default:
+            return false;
+    }
+}
+
+#endif
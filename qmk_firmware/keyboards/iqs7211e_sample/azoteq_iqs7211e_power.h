@@ -0,0 +1,90 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Power telemetry: the sensor reports its charging mode in every frame, so
+// the time spent in each mode is accumulated from the frames the driver
+// already reads; silent stretches in event mode are split by the configured
+// mode timeouts. The current estimate is a charge budget: mode residency
+// times the cost table below, plus a per-transfer and per-wake cost for the
+// MCU side. 1 uA for 1 ms is 1 nC, so the table needs no scaling.
+
+// Sensor supply current per charging mode, in uA; measure on the target board
+#ifndef AZOTEQ_IQS7211E_POWER_ACTIVE_UA
+#    define AZOTEQ_IQS7211E_POWER_ACTIVE_UA 1500
+#endif
+#ifndef AZOTEQ_IQS7211E_POWER_IDLE_TOUCH_UA
+#    define AZOTEQ_IQS7211E_POWER_IDLE_TOUCH_UA 500
+#endif
+#ifndef AZOTEQ_IQS7211E_POWER_IDLE_UA
+#    define AZOTEQ_IQS7211E_POWER_IDLE_UA 150
+#endif
+#ifndef AZOTEQ_IQS7211E_POWER_LP1_UA
+#    define AZOTEQ_IQS7211E_POWER_LP1_UA 50
+#endif
+#ifndef AZOTEQ_IQS7211E_POWER_LP2_UA
+#    define AZOTEQ_IQS7211E_POWER_LP2_UA 15
+#endif
+
+// Charge of one I2C transaction (address, register and pull-ups) and of each byte in it, in nC
+#ifndef AZOTEQ_IQS7211E_POWER_TRANSFER_NC
+#    define AZOTEQ_IQS7211E_POWER_TRANSFER_NC 30
+#endif
+#ifndef AZOTEQ_IQS7211E_POWER_BYTE_NC
+#    define AZOTEQ_IQS7211E_POWER_BYTE_NC 10
+#endif
+
+// Charge of one MCU wake to service a communication window, in nC
+#ifndef AZOTEQ_IQS7211E_POWER_WAKE_NC
+#    define AZOTEQ_IQS7211E_POWER_WAKE_NC 100
+#endif
+
+// Value id on the custom channel; id_custom_get_value reads the page in [3],
+// see azoteq_iqs7211e_power_command, and id_custom_set_value resets the counters
+#define AZOTEQ_IQS7211E_POWER_VALUE_ID 0x82
+
+// Charging modes, in the order of the info flags encoding
+typedef enum {
+    AZOTEQ_IQS7211E_POWER_ACTIVE = 0,
+    AZOTEQ_IQS7211E_POWER_IDLE_TOUCH,
+    AZOTEQ_IQS7211E_POWER_IDLE,
+    AZOTEQ_IQS7211E_POWER_LP1,
+    AZOTEQ_IQS7211E_POWER_LP2,
+    AZOTEQ_IQS7211E_POWER_MODE_COUNT,
+} azoteq_iqs7211e_power_mode_t;
+
+typedef struct {
+    uint32_t residency_ms[AZOTEQ_IQS7211E_POWER_MODE_COUNT];
+    uint32_t transfers;      // I2C transactions started by the MCU
+    uint32_t transfer_bytes; // payload bytes of those transactions
+    uint32_t wakes;          // communication windows opened
+    uint16_t mode_changes;
+    uint16_t average_ua;     // estimated mean current since the last reset
+    uint8_t  mode;           // azoteq_iqs7211e_power_mode_t the sensor is in by now
+} azoteq_iqs7211e_power_stats_t;
+
+void azoteq_iqs7211e_power_update(uint8_t info_flags);
+void azoteq_iqs7211e_power_count_transfer(uint16_t length);
+void azoteq_iqs7211e_power_count_wake(void);
+void azoteq_iqs7211e_power_get_stats(azoteq_iqs7211e_power_stats_t *stats);
+void azoteq_iqs7211e_power_reset_stats(void);
+bool azoteq_iqs7211e_power_command(uint8_t *data, uint8_t length);
@@ -0,0 +1,90 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_predictor.h"
+#include <stdlib.h>
+
+static void azoteq_iqs7211e_predictor_axis_reset(azoteq_iqs7211e_predictor_axis_t *axis, uint16_t z) {
+    axis->position = (int32_t)z << 8;
+    axis->velocity = 0;
+    axis->emitted  = z;
+    axis->measured = z;
+}
+
+// Returns the delta to report for this axis. The lead never exceeds what the
+// last frame moved scaled to the horizon, so it shrinks as the finger slows,
+// and motion against the measured direction is withheld while the finger
+// moves. A frame where the axis did not move halves the lead still
+// outstanding, so the cursor eases back onto a finger that stopped over a
+// few frames, and the filter keeps its velocity for when the axis resumes.
+static int16_t azoteq_iqs7211e_predictor_axis_update(azoteq_iqs7211e_predictor_axis_t *axis, uint16_t z, uint16_t dt_ms) {
+    int32_t raw = (int32_t)z - axis->measured;
+    axis->measured = z;
+
+    // Alpha-beta update
+    int32_t predicted = axis->position + axis->velocity * dt_ms;
+    int32_t residual  = ((int32_t)z << 8) - predicted;
+    axis->position    = predicted + ((residual * AZOTEQ_IQS7211E_PREDICT_ALPHA) >> 8);
+    axis->velocity += ((residual * AZOTEQ_IQS7211E_PREDICT_BETA) >> 8) / dt_ms;
+
+    if (raw == 0) {
+        int32_t delta = ((int32_t)z + (axis->emitted - (int32_t)z) / 2) - axis->emitted;
+        axis->emitted += delta;
+        return delta;
+    }
+
+    // Lead towards the expected send time
+    int32_t lead  = (((axis->velocity * AZOTEQ_IQS7211E_PREDICT_HORIZON_MS) >> 8) * AZOTEQ_IQS7211E_PREDICT_DAMPING) >> 8;
+    int32_t limit = abs(raw) * AZOTEQ_IQS7211E_PREDICT_HORIZON_MS / dt_ms;
+    if (limit > AZOTEQ_IQS7211E_PREDICT_MAX_LEAD) {
+        limit = AZOTEQ_IQS7211E_PREDICT_MAX_LEAD;
+    }
+    if ((lead ^ raw) < 0) {
+        lead = 0;
+    } else if (lead > limit) {
+        lead = limit;
+    } else if (lead < -limit) {
+        lead = -limit;
+    }
+
+    int32_t delta = (axis->position >> 8) + lead - axis->emitted;
+    if ((delta ^ raw) < 0) {
+        delta = 0;
+    } else if (abs(delta) > 2 * abs(raw)) {
+        delta = 2 * raw;
+    }
+
+    axis->emitted += delta;
+    return delta;
+}
+
+void azoteq_iqs7211e_predictor_reset(azoteq_iqs7211e_predictor_t *predictor, uint16_t x, uint16_t y) {
+    azoteq_iqs7211e_predictor_axis_reset(&predictor->x, x);
+    azoteq_iqs7211e_predictor_axis_reset(&predictor->y, y);
+}
+
+bool azoteq_iqs7211e_predictor_settled(const azoteq_iqs7211e_predictor_t *predictor) {
+    return predictor->x.emitted == predictor->x.measured && predictor->y.emitted == predictor->y.measured;
+}
+
+void azoteq_iqs7211e_predictor_update(azoteq_iqs7211e_predictor_t *predictor, uint16_t x, uint16_t y, uint16_t dt_ms, int16_t *dx, int16_t *dy) {
+    if (dt_ms == 0) {
+        dt_ms = 1;
+    }
+    *dx = azoteq_iqs7211e_predictor_axis_update(&predictor->x, x, dt_ms);
+    *dy = azoteq_iqs7211e_predictor_axis_update(&predictor->y, y, dt_ms);
+}
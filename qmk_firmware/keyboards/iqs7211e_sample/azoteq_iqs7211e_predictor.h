@@ -0,0 +1,61 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// How far ahead of the last frame the position is extrapolated, in ms
+#ifndef AZOTEQ_IQS7211E_PREDICT_HORIZON_MS
+#    define AZOTEQ_IQS7211E_PREDICT_HORIZON_MS 8
+#endif
+
+// Fraction of the extrapolated lead that is applied, Q8 (256 = 1.0)
+#ifndef AZOTEQ_IQS7211E_PREDICT_DAMPING
+#    define AZOTEQ_IQS7211E_PREDICT_DAMPING 192
+#endif
+
+// Alpha-beta filter gains, Q8
+#ifndef AZOTEQ_IQS7211E_PREDICT_ALPHA
+#    define AZOTEQ_IQS7211E_PREDICT_ALPHA 192
+#endif
+#ifndef AZOTEQ_IQS7211E_PREDICT_BETA
+#    define AZOTEQ_IQS7211E_PREDICT_BETA 115
+#endif
+
+// Upper bound on the lead, in sensor counts
+#ifndef AZOTEQ_IQS7211E_PREDICT_MAX_LEAD
+#    define AZOTEQ_IQS7211E_PREDICT_MAX_LEAD 32
+#endif
+
+typedef struct {
+    int32_t position; // filtered position, Q8 counts
+    int32_t velocity; // Q8 counts per ms
+    int32_t emitted;  // position reported so far, counts
+    int32_t measured; // last measured position, counts
+} azoteq_iqs7211e_predictor_axis_t;
+
+typedef struct {
+    azoteq_iqs7211e_predictor_axis_t x;
+    azoteq_iqs7211e_predictor_axis_t y;
+} azoteq_iqs7211e_predictor_t;
+
+void azoteq_iqs7211e_predictor_reset(azoteq_iqs7211e_predictor_t *predictor, uint16_t x, uint16_t y);
+void azoteq_iqs7211e_predictor_update(azoteq_iqs7211e_predictor_t *predictor, uint16_t x, uint16_t y, uint16_t dt_ms, int16_t *dx, int16_t *dy);
+// False while the reported position still leads the finger
+bool azoteq_iqs7211e_predictor_settled(const azoteq_iqs7211e_predictor_t *predictor);
@@ -0,0 +1,200 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_ptp.h"
+#include "IQS7211_init.h"
+#include <string.h>
+
+#define AZOTEQ_IQS7211E_PTP_X_MAX ((X_RESOLUTION_1 << 8) | X_RESOLUTION_0)
+#define AZOTEQ_IQS7211E_PTP_Y_MAX ((Y_RESOLUTION_1 << 8) | Y_RESOLUTION_0)
+#define AZOTEQ_IQS7211E_PTP_SIZE_01MM (AZOTEQ_IQS7211E_PAD_SIZE_MM * 10)
+
+// Sensing surface only, no physical button; two contacts
+#define AZOTEQ_IQS7211E_PTP_PAD_TYPE 2
+#define AZOTEQ_IQS7211E_PTP_MAX_CONTACTS 2
+
+#define AZOTEQ_IQS7211E_PTP_FINGER_COLLECTION                                                              \
+    0x05, 0x0D,                                                       /* Usage Page (Digitizer) */         \
+    0x09, 0x22,                                                       /* Usage (Finger) */                 \
+    0xA1, 0x02,                                                       /* Collection (Logical) */           \
+    0x15, 0x00,                                                       /*   Logical Minimum (0) */          \
+    0x25, 0x01,                                                       /*   Logical Maximum (1) */          \
+    0x09, 0x47,                                                       /*   Usage (Confidence) */           \
+    0x09, 0x42,                                                       /*   Usage (Tip Switch) */           \
+    0x75, 0x01,                                                       /*   Report Size (1) */              \
+    0x95, 0x02,                                                       /*   Report Count (2) */             \
+    0x81, 0x02,                                                       /*   Input (Data, Var, Abs) */       \
+    0x95, 0x06,                                                       /*   Report Count (6) */             \
+    0x81, 0x03,                                                       /*   Input (Const) */                \
+    0x25, 0x0F,                                                       /*   Logical Maximum (15) */         \
+    0x09, 0x51,                                                       /*   Usage (Contact Identifier) */   \
+    0x75, 0x08,                                                       /*   Report Size (8) */              \
+    0x95, 0x01,                                                       /*   Report Count (1) */             \
+    0x81, 0x02,                                                       /*   Input (Data, Var, Abs) */       \
+    0x05, 0x01,                                                       /*   Usage Page (Generic Desktop) */ \
+    0x75, 0x10,                                                       /*   Report Size (16) */             \
+    0x55, 0x0E,                                                       /*   Unit Exponent (-2) */           \
+    0x65, 0x11,                                                       /*   Unit (cm) */                    \
+    0x35, 0x00,                                                       /*   Physical Minimum (0) */         \
+    0x26, AZOTEQ_IQS7211E_LOW_BYTE(AZOTEQ_IQS7211E_PTP_X_MAX),        /*   Logical Maximum (x) */          \
+    AZOTEQ_IQS7211E_HIGH_BYTE(AZOTEQ_IQS7211E_PTP_X_MAX),                                                  \
+    0x46, AZOTEQ_IQS7211E_LOW_BYTE(AZOTEQ_IQS7211E_PTP_SIZE_01MM),    /*   Physical Maximum */             \
+    AZOTEQ_IQS7211E_HIGH_BYTE(AZOTEQ_IQS7211E_PTP_SIZE_01MM),                                              \
+    0x09, 0x30,                                                       /*   Usage (X) */                    \
+    0x81, 0x02,                                                       /*   Input (Data, Var, Abs) */       \
+    0x26, AZOTEQ_IQS7211E_LOW_BYTE(AZOTEQ_IQS7211E_PTP_Y_MAX),        /*   Logical Maximum (y) */          \
+    AZOTEQ_IQS7211E_HIGH_BYTE(AZOTEQ_IQS7211E_PTP_Y_MAX),                                                  \
+    0x09, 0x31,                                                       /*   Usage (Y) */                    \
+    0x81, 0x02,                                                       /*   Input (Data, Var, Abs) */       \
+    0xC0                                                              /* End Collection */
+
+// Windows precision touchpad collection set. Windows additionally asks for the
+// vendor certification blob (feature 0xC5), which is not provided here.
+const uint8_t azoteq_iqs7211e_ptp_descriptor[] = {
+    0x05, 0x0D,                                 // Usage Page (Digitizer)
+    0x09, 0x05,                                 // Usage (Touch Pad)
+    0xA1, 0x01,                                 // Collection (Application)
+    0x85, AZOTEQ_IQS7211E_PTP_REPORT_ID,        //   Report ID
+    AZOTEQ_IQS7211E_PTP_FINGER_COLLECTION,
+    AZOTEQ_IQS7211E_PTP_FINGER_COLLECTION,
+    0x05, 0x0D,                                 //   Usage Page (Digitizer)
+    0x55, 0x0C,                                 //   Unit Exponent (-4)
+    0x66, 0x01, 0x10,                           //   Unit (s)
+    0x47, 0xFF, 0xFF, 0x00, 0x00,               //   Physical Maximum (65535)
+    0x27, 0xFF, 0xFF, 0x00, 0x00,               //   Logical Maximum (65535)
+    0x75, 0x10,                                 //   Report Size (16)
+    0x95, 0x01,                                 //   Report Count (1)
+    0x09, 0x56,                                 //   Usage (Scan Time)
+    0x81, 0x02,                                 //   Input (Data, Var, Abs)
+    0x65, 0x00,                                 //   Unit (None)
+    0x55, 0x00,                                 //   Unit Exponent (0)
+    0x25, 0x7F,                                 //   Logical Maximum (127)
+    0x75, 0x08,                                 //   Report Size (8)
+    0x09, 0x54,                                 //   Usage (Contact Count)
+    0x81, 0x02,                                 //   Input (Data, Var, Abs)
+    0x05, 0x09,                                 //   Usage Page (Button)
+    0x09, 0x01,                                 //   Usage (Button 1)
+    0x25, 0x01,                                 //   Logical Maximum (1)
+    0x75, 0x01,                                 //   Report Size (1)
+    0x81, 0x02,                                 //   Input (Data, Var, Abs)
+    0x95, 0x07,                                 //   Report Count (7)
+    0x81, 0x03,                                 //   Input (Const)
+    0x05, 0x0D,                                 //   Usage Page (Digitizer)
+    0x85, AZOTEQ_IQS7211E_PTP_CAPS_REPORT_ID,   //   Report ID
+    0x09, 0x55,                                 //   Usage (Contact Count Maximum)
+    0x09, 0x59,                                 //   Usage (Pad Type)
+    0x25, 0x0F,                                 //   Logical Maximum (15)
+    0x75, 0x04,                                 //   Report Size (4)
+    0x95, 0x02,                                 //   Report Count (2)
+    0xB1, 0x02,                                 //   Feature (Data, Var, Abs)
+    0xC0,                                       // End Collection
+
+    0x05, 0x0D,                                 // Usage Page (Digitizer)
+    0x09, 0x0E,                                 // Usage (Device Configuration)
+    0xA1, 0x01,                                 // Collection (Application)
+    0x85, AZOTEQ_IQS7211E_PTP_INPUT_MODE_REPORT_ID, // Report ID
+    0x09, 0x22,                                 //   Usage (Finger)
+    0xA1, 0x02,                                 //   Collection (Logical)
+    0x09, 0x52,                                 //     Usage (Input Mode)
+    0x15, 0x00,                                 //     Logical Minimum (0)
+    0x25, 0x0A,                                 //     Logical Maximum (10)
+    0x75, 0x08,                                 //     Report Size (8)
+    0x95, 0x01,                                 //     Report Count (1)
+    0xB1, 0x02,                                 //     Feature (Data, Var, Abs)
+    0xC0,                                       //   End Collection
+    0x09, 0x22,                                 //   Usage (Finger)
+    0xA1, 0x00,                                 //   Collection (Physical)
+    0x85, AZOTEQ_IQS7211E_PTP_SELECTIVE_REPORT_ID, // Report ID
+    0x09, 0x57,                                 //     Usage (Surface Switch)
+    0x09, 0x58,                                 //     Usage (Button Switch)
+    0x75, 0x01,                                 //     Report Size (1)
+    0x95, 0x02,                                 //     Report Count (2)
+    0x25, 0x01,                                 //     Logical Maximum (1)
+    0xB1, 0x02,                                 //     Feature (Data, Var, Abs)
+    0x95, 0x06,                                 //     Report Count (6)
+    0xB1, 0x03,                                 //     Feature (Const)
+    0xC0,                                       //   End Collection
+    0xC0,                                       // End Collection
+};
+
+const uint16_t azoteq_iqs7211e_ptp_descriptor_size = sizeof(azoteq_iqs7211e_ptp_descriptor);
+
+// Mouse reports until the host selects touchpad mode
+static uint8_t azoteq_iqs7211e_ptp_input_mode     = 0;
+static bool    azoteq_iqs7211e_ptp_surface_enable = true;
+
+bool azoteq_iqs7211e_ptp_active(void) {
+    return azoteq_iqs7211e_ptp_input_mode == AZOTEQ_IQS7211E_PTP_INPUT_MODE_TOUCHPAD && azoteq_iqs7211e_ptp_surface_enable;
+}
+
+// Straight copy from the burst buffer: the sensor keeps finger 1 and 2 in
+// their slots while they are down, and marks an empty slot with 0xFFFF
+// coordinates, so a finger lifting leaves the other one where it was
+void azoteq_iqs7211e_ptp_fill(azoteq_iqs7211e_ptp_report_t *report, const azoteq_iqs7211e_base_data_t *base_data, uint32_t capture_us) {
+    uint8_t confidence = (base_data->gestures[0] & (1 << IQS7211E_GESTURE_PALM_BIT)) ? 0 : (1 << AZOTEQ_IQS7211E_PTP_CONFIDENCE_BIT);
+
+    report->report_id     = AZOTEQ_IQS7211E_PTP_REPORT_ID;
+    report->contact_count = 0;
+    for (uint8_t i = 0; i < AZOTEQ_IQS7211E_PTP_MAX_CONTACTS; i++) {
+        bool tip = azoteq_iqs7211e_finger_present(base_data, i);
+
+        report->contact[i].flags      = confidence | (tip ? (1 << AZOTEQ_IQS7211E_PTP_TIP_BIT) : 0);
+        report->contact[i].contact_id = i;
+        memcpy(&report->contact[i].x, &base_data->finger[i].x, 4);
+        report->contact_count += tip;
+    }
+    report->scan_time = capture_us / 100;
+    report->buttons   = 0;
+}
+
+uint8_t azoteq_iqs7211e_ptp_get_feature(uint8_t report_id, uint8_t *data, uint8_t length) {
+    if (length < 2) {
+        return 0;
+    }
+    data[0] = report_id;
+    switch (report_id) {
+        case AZOTEQ_IQS7211E_PTP_CAPS_REPORT_ID:
+            data[1] = AZOTEQ_IQS7211E_PTP_MAX_CONTACTS | (AZOTEQ_IQS7211E_PTP_PAD_TYPE << 4);
+            return 2;
+        case AZOTEQ_IQS7211E_PTP_INPUT_MODE_REPORT_ID:
+            data[1] = azoteq_iqs7211e_ptp_input_mode;
+            return 2;
+        case AZOTEQ_IQS7211E_PTP_SELECTIVE_REPORT_ID:
+            data[1] = azoteq_iqs7211e_ptp_surface_enable ? 0x03 : 0x02;
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+bool azoteq_iqs7211e_ptp_set_feature(uint8_t report_id, const uint8_t *data, uint8_t length) {
+    if (length < 2 || data[0] != report_id) {
+        return false;
+    }
+    switch (report_id) {
+        case AZOTEQ_IQS7211E_PTP_INPUT_MODE_REPORT_ID:
+            azoteq_iqs7211e_ptp_input_mode = data[1];
+            dprintf("IQS7211E: PTP input mode %d\n", azoteq_iqs7211e_ptp_input_mode);
+            return true;
+        case AZOTEQ_IQS7211E_PTP_SELECTIVE_REPORT_ID:
+            azoteq_iqs7211e_ptp_surface_enable = data[1] & 0x01;
+            return true;
+        default:
+            return false;
+    }
+}
+
@@ -0,0 +1,73 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "azoteq_iqs7211e.h"
+
+// Precision touchpad output. QMK has no digitizer interface, so the module is
+// only built with AZOTEQ_IQS7211E_PTP_ENABLE = yes in rules.mk, and the
+// keyboard then has to provide the USB side:
+//   - azoteq_iqs7211e_ptp_descriptor in the report descriptor of a HID interface,
+//   - GET_REPORT / SET_REPORT (feature) on that interface routed to
+//     azoteq_iqs7211e_ptp_get_feature / azoteq_iqs7211e_ptp_set_feature,
+//   - azoteq_iqs7211e_ptp_send below.
+// Until the host writes the touchpad input mode, mouse reports are sent as usual.
+
+// Report ids of the precision touchpad collection; must not clash with the keyboard's own reports
+#ifndef AZOTEQ_IQS7211E_PTP_REPORT_ID
+#    define AZOTEQ_IQS7211E_PTP_REPORT_ID 0x10
+#endif
+#define AZOTEQ_IQS7211E_PTP_CAPS_REPORT_ID (AZOTEQ_IQS7211E_PTP_REPORT_ID + 1)
+#define AZOTEQ_IQS7211E_PTP_INPUT_MODE_REPORT_ID (AZOTEQ_IQS7211E_PTP_REPORT_ID + 2)
+#define AZOTEQ_IQS7211E_PTP_SELECTIVE_REPORT_ID (AZOTEQ_IQS7211E_PTP_REPORT_ID + 3)
+
+// Input mode value the host writes to switch from mouse to touchpad reports
+#define AZOTEQ_IQS7211E_PTP_INPUT_MODE_TOUCHPAD 3
+
+#define AZOTEQ_IQS7211E_PTP_CONFIDENCE_BIT 0
+#define AZOTEQ_IQS7211E_PTP_TIP_BIT 1
+
+typedef struct __attribute__((packed)) {
+    uint8_t  flags; // confidence, tip switch
+    uint8_t  contact_id;
+    uint16_t x;
+    uint16_t y;
+} azoteq_iqs7211e_ptp_contact_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t                       report_id;
+    azoteq_iqs7211e_ptp_contact_t contact[2];
+    uint16_t                      scan_time; // 100 us units
+    uint8_t                       contact_count;
+    uint8_t                       buttons;
+} azoteq_iqs7211e_ptp_report_t;
+
+_Static_assert(sizeof(azoteq_iqs7211e_ptp_report_t) == 17, "PTP report layout does not match the descriptor");
+
+extern const uint8_t  azoteq_iqs7211e_ptp_descriptor[];
+extern const uint16_t azoteq_iqs7211e_ptp_descriptor_size;
+
+bool    azoteq_iqs7211e_ptp_active(void);
+void    azoteq_iqs7211e_ptp_fill(azoteq_iqs7211e_ptp_report_t *report, const azoteq_iqs7211e_base_data_t *base_data, uint32_t capture_us);
+uint8_t azoteq_iqs7211e_ptp_get_feature(uint8_t report_id, uint8_t *data, uint8_t length);
+bool    azoteq_iqs7211e_ptp_set_feature(uint8_t report_id, const uint8_t *data, uint8_t length);
+
+// Hand a finished report to the USB stack; provided by the keyboard, there is no default
+void azoteq_iqs7211e_ptp_send(const azoteq_iqs7211e_ptp_report_t *report);
@@ -0,0 +1,124 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_qmk.h"
+#include "azoteq_iqs7211e_split.h"
+#include "pointing_device_internal.h"
+#include "debug.h"
+
+#ifdef VIA_ENABLE
+#    include "via.h"
+#elif defined(RAW_ENABLE)
+#    include "raw_hid.h"
+#endif
+
+static void azoteq_iqs7211e_qmk_set_cpi(uint16_t cpi) {
+    azoteq_iqs7211e_set_cpi(cpi);
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+    // The pointer is scaled on the pad half
+    azoteq_iqs7211e_split_set_cpi(cpi);
+#endif
+}
+
+const pointing_device_driver_t azoteq_iqs7211e_pointing_device_driver = {
+    .init       = azoteq_iqs7211e_init,
+    .get_report = azoteq_iqs7211e_get_report,
+    .set_cpi    = azoteq_iqs7211e_qmk_set_cpi,
+    .get_cpi    = azoteq_iqs7211e_get_cpi,
+};
+
+#if defined(AZOTEQ_IQS7211E_SPLIT_ENABLE) && defined(AZOTEQ_IQS7211E_FRAME_STATS_INTERVAL)
+// The master decodes no sensor frames, so it reports the split link instead
+static void azoteq_iqs7211e_split_print_stats(void) {
+    static uint32_t               printed = 0;
+    azoteq_iqs7211e_split_stats_t stats;
+
+    azoteq_iqs7211e_split_get_stats(&stats);
+    if (stats.frames - printed >= AZOTEQ_IQS7211E_FRAME_STATS_INTERVAL) {
+        printed = stats.frames;
+        dprintf("IQS7211E: split %lu frames, %lu bytes, %u bytes/s saved\n", (unsigned long)stats.frames, (unsigned long)stats.bytes, stats.bytes_saved_per_second);
+    }
+}
+#endif
+
+report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report) {
+    report_mouse_t           temp_report = {0};
+    azoteq_iqs7211e_motion_t motion;
+
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+    if (!is_keyboard_master()) {
+        // The pad half only feeds the split link
+        azoteq_iqs7211e_split_send(azoteq_iqs7211e_read_motion());
+        return temp_report;
+    }
+    motion = azoteq_iqs7211e_split_receive();
+#ifdef AZOTEQ_IQS7211E_FRAME_STATS_INTERVAL
+    azoteq_iqs7211e_split_print_stats();
+#endif
+#else
+    motion = azoteq_iqs7211e_read_motion();
+#endif
+
+    temp_report.x       = CONSTRAIN_HID_XY(motion.x);
+    temp_report.y       = CONSTRAIN_HID_XY(motion.y);
+    temp_report.v       = CONSTRAIN_HID(motion.v);
+    temp_report.h       = CONSTRAIN_HID(motion.h);
+    temp_report.buttons = (motion.buttons & AZOTEQ_IQS7211E_BUTTON_1 ? MOUSE_BTN1 : 0) | (motion.buttons & AZOTEQ_IQS7211E_BUTTON_2 ? MOUSE_BTN2 : 0);
+
+    return temp_report;
+}
+
+#ifdef VIA_ENABLE
+void via_custom_value_command_kb(uint8_t *data, uint8_t length) {
+    if (data[1] != id_custom_channel || !azoteq_iqs7211e_tunables_command(data, length)) {
+        data[0] = id_unhandled;
+    }
+}
+#elif defined(RAW_ENABLE)
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (!azoteq_iqs7211e_tunables_command(data, length)) {
+        data[0] = 0xFF;
+    }
+    raw_hid_send(data, length);
+}
+#endif
+
+void pointing_device_driver_init(void) {
+#if (!defined(VIA_ENABLE) && !defined(RAW_ENABLE)) || defined(AZOTEQ_IQS7211E_TRACE_ENABLE)
+    // Trace lines and the event log drain go out over the console
+    debug_enable = true;
+#endif
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+    azoteq_iqs7211e_split_init();
+    if (is_keyboard_master()) {
+        return; // the sensor is on the other half
+    }
+#endif
+    azoteq_iqs7211e_init();
+}
+
+report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
+    return azoteq_iqs7211e_get_report(mouse_report);
+}
+
+void pointing_device_driver_set_cpi(uint16_t cpi) {
+    azoteq_iqs7211e_qmk_set_cpi(cpi);
+}
+
+uint16_t pointing_device_driver_get_cpi(void) {
+    return azoteq_iqs7211e_get_cpi();
+}
@@ -0,0 +1,27 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// QMK pointing device glue around the portable IQS7211E core
+
+#include "azoteq_iqs7211e.h"
+#include "pointing_device.h"
+
+report_mouse_t azoteq_iqs7211e_get_report(report_mouse_t mouse_report);
+
+extern const pointing_device_driver_t azoteq_iqs7211e_pointing_device_driver;
@@ -0,0 +1,114 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_rim.h"
+#include "azoteq_iqs7211e_transform.h"
+#include "IQS7211_init.h"
+#include <stdlib.h>
+
+#define AZOTEQ_IQS7211E_RIM_X_RESOLUTION ((X_RESOLUTION_1 << 8) | X_RESOLUTION_0)
+#define AZOTEQ_IQS7211E_RIM_Y_RESOLUTION ((Y_RESOLUTION_1 << 8) | Y_RESOLUTION_0)
+#define AZOTEQ_IQS7211E_RIM_RADIUS (AZOTEQ_IQS7211E_RIM_X_RESOLUTION / 2)
+#define AZOTEQ_IQS7211E_RIM_START_RADIUS ((int32_t)AZOTEQ_IQS7211E_RIM_RADIUS * AZOTEQ_IQS7211E_RIM_START_PERCENT / 100)
+
+// atan(i / 32) for i = 0..32, in 1/16 angle units (2048 = 1/8 turn)
+static const uint16_t azoteq_iqs7211e_atan_table[33] = {
+    0, 81, 163, 244, 324, 404, 483, 562,
+    639, 715, 790, 863, 936, 1006, 1075, 1143,
+    1209, 1273, 1336, 1397, 1457, 1514, 1571, 1625,
+    1678, 1729, 1779, 1828, 1874, 1920, 1964, 2007,
+    2048,
+};
+
+// atan(num / den) for 0 <= num <= den, in 1/16 angle units
+static uint16_t azoteq_iqs7211e_atan_octant(uint16_t num, uint16_t den) {
+    uint32_t t     = ((uint32_t)num << 13) / den; // ratio, Q8 table steps
+    uint8_t  index = t >> 8;
+    uint8_t  frac  = t & 0xFF;
+
+    if (index >= 32) {
+        return azoteq_iqs7211e_atan_table[32];
+    }
+    return azoteq_iqs7211e_atan_table[index] + (((azoteq_iqs7211e_atan_table[index + 1] - azoteq_iqs7211e_atan_table[index]) * frac) >> 8);
+}
+
+// Angle of (x, y) in 1/1024 turns, counted from +x towards +y
+uint16_t azoteq_iqs7211e_atan2(int16_t y, int16_t x) {
+    uint16_t ax = abs(x);
+    uint16_t ay = abs(y);
+    uint16_t angle;
+
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+
+    // Fold into the first octant, then unfold
+    if (ax >= ay) {
+        angle = azoteq_iqs7211e_atan_octant(ay, ax);
+    } else {
+        angle = (AZOTEQ_IQS7211E_ANGLE_TURN / 4) * 16 - azoteq_iqs7211e_atan_octant(ax, ay);
+    }
+    angle = (angle + 8) >> 4;
+
+    if (x < 0) {
+        angle = AZOTEQ_IQS7211E_ANGLE_TURN / 2 - angle;
+    }
+    if (y < 0) {
+        angle = AZOTEQ_IQS7211E_ANGLE_TURN - angle;
+    }
+    return angle & (AZOTEQ_IQS7211E_ANGLE_TURN - 1);
+}
+
+// Position relative to the pad centre, with y scaled so the pad is a circle in x units
+static void azoteq_iqs7211e_rim_polar(uint16_t x, uint16_t y, int16_t *px, int16_t *py) {
+    *px = (int16_t)x - AZOTEQ_IQS7211E_RIM_X_RESOLUTION / 2;
+    *py = ((int32_t)y - AZOTEQ_IQS7211E_RIM_Y_RESOLUTION / 2) * AZOTEQ_IQS7211E_RIM_X_RESOLUTION / AZOTEQ_IQS7211E_RIM_Y_RESOLUTION;
+}
+
+bool azoteq_iqs7211e_rim_is_edge(uint16_t x, uint16_t y) {
+    int16_t px, py;
+    azoteq_iqs7211e_rim_polar(x, y, &px, &py);
+    return (int32_t)px * px + (int32_t)py * py >= AZOTEQ_IQS7211E_RIM_START_RADIUS * AZOTEQ_IQS7211E_RIM_START_RADIUS;
+}
+
+void azoteq_iqs7211e_rim_start(azoteq_iqs7211e_rim_t *rim, uint16_t x, uint16_t y) {
+    int16_t px, py;
+    azoteq_iqs7211e_rim_polar(x, y, &px, &py);
+    rim->angle     = azoteq_iqs7211e_atan2(py, px);
+    rim->remainder = 0;
+}
+
+// Wheel clicks for the angular movement since the last frame; clockwise scrolls down
+int8_t azoteq_iqs7211e_rim_update(azoteq_iqs7211e_rim_t *rim, uint16_t x, uint16_t y) {
+    int16_t px, py;
+    azoteq_iqs7211e_rim_polar(x, y, &px, &py);
+
+    uint16_t angle = azoteq_iqs7211e_atan2(py, px);
+    int16_t  delta = (int16_t)((angle - rim->angle) & (AZOTEQ_IQS7211E_ANGLE_TURN - 1));
+    if (delta >= AZOTEQ_IQS7211E_ANGLE_TURN / 2) {
+        delta -= AZOTEQ_IQS7211E_ANGLE_TURN;
+    }
+    rim->angle = angle;
+
+    rim->remainder += delta;
+    int16_t clicks = rim->remainder / AZOTEQ_IQS7211E_RIM_SCROLL_DIVISOR;
+    rim->remainder -= clicks * AZOTEQ_IQS7211E_RIM_SCROLL_DIVISOR;
+
+    // Sensor y grows downwards, so a positive angle is a clockwise turn,
+    // unless the mounting mirrors the pad
+    return -clicks * AZOTEQ_IQS7211E_TRANSFORM_HANDEDNESS;
+}
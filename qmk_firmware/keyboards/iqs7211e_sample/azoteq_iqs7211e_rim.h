@@ -0,0 +1,44 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Angles are binary: one full turn is this many units
+#define AZOTEQ_IQS7211E_ANGLE_TURN 1024
+
+// A touch starting outside this fraction of the pad radius, in percent, becomes a rim scroll
+#ifndef AZOTEQ_IQS7211E_RIM_START_PERCENT
+#    define AZOTEQ_IQS7211E_RIM_START_PERCENT 80
+#endif
+
+// Angle units per wheel click; 32 gives 32 clicks per turn
+#ifndef AZOTEQ_IQS7211E_RIM_SCROLL_DIVISOR
+#    define AZOTEQ_IQS7211E_RIM_SCROLL_DIVISOR 32
+#endif
+
+typedef struct {
+    uint16_t angle;
+    int16_t  remainder;
+} azoteq_iqs7211e_rim_t;
+
+uint16_t azoteq_iqs7211e_atan2(int16_t y, int16_t x);
+bool     azoteq_iqs7211e_rim_is_edge(uint16_t x, uint16_t y);
+void     azoteq_iqs7211e_rim_start(azoteq_iqs7211e_rim_t *rim, uint16_t x, uint16_t y);
+int8_t   azoteq_iqs7211e_rim_update(azoteq_iqs7211e_rim_t *rim, uint16_t x, uint16_t y);
@@ -0,0 +1,328 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_split.h"
+
+#ifdef AZOTEQ_IQS7211E_SPLIT_ENABLE
+
+#include "quantum.h"
+#include "transactions.h"
+#include "azoteq_iqs7211e_units.h"
+#include <stdatomic.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t  version;
+    uint8_t  ack; // sequence of the last frame the master received
+    uint16_t cpi; // set on the master, 0 while it was never set
+} azoteq_iqs7211e_split_query_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t sequence;
+    uint8_t length; // 0 when nothing is staged
+} azoteq_iqs7211e_split_answer_t;
+
+// Peripheral: motion accumulated since the last staged frame
+static int32_t  azoteq_iqs7211e_split_x = 0, azoteq_iqs7211e_split_y = 0;
+static int16_t  azoteq_iqs7211e_split_v = 0, azoteq_iqs7211e_split_h = 0;
+static uint8_t  azoteq_iqs7211e_split_buttons        = 0;
+static uint8_t  azoteq_iqs7211e_split_pressed        = 0;
+static uint8_t  azoteq_iqs7211e_split_staged_buttons = 0;
+static bool     azoteq_iqs7211e_split_ctrl           = false;
+static bool     azoteq_iqs7211e_split_staged_ctrl    = false;
+static uint16_t azoteq_iqs7211e_split_keycodes[AZOTEQ_IQS7211E_SPLIT_KEYCODES];
+static uint8_t  azoteq_iqs7211e_split_keycode_count = 0;
+
+// Peripheral: two frame slots, so the next frame can be staged while the
+// master still has to acknowledge the previous one. The main loop only writes
+// a slot while its length is 0, the transaction handlers only clear it.
+static uint8_t           azoteq_iqs7211e_split_frame[2][AZOTEQ_IQS7211E_SPLIT_FRAME_MAX];
+static volatile uint8_t  azoteq_iqs7211e_split_frame_length[2]   = {0};
+static uint8_t           azoteq_iqs7211e_split_frame_sequence[2] = {0};
+static volatile uint8_t  azoteq_iqs7211e_split_deliver           = 0; // slot the master gets next
+static uint8_t           azoteq_iqs7211e_split_sequence          = 0;
+static volatile uint16_t azoteq_iqs7211e_split_requested_cpi     = 0; // from the last query
+
+// Master
+static uint32_t                      azoteq_iqs7211e_split_sync_time     = 0;
+static uint8_t                       azoteq_iqs7211e_split_received      = 0;
+static azoteq_iqs7211e_motion_t      azoteq_iqs7211e_split_motion        = {0};
+static uint8_t                       azoteq_iqs7211e_split_button_pulse  = 0;
+static bool                          azoteq_iqs7211e_split_master_ctrl   = false;
+static azoteq_iqs7211e_split_stats_t azoteq_iqs7211e_split_stats         = {0};
+static uint32_t                      azoteq_iqs7211e_split_window_time   = 0;
+static uint32_t                      azoteq_iqs7211e_split_window_bytes  = 0;
+static uint16_t                      azoteq_iqs7211e_split_window_syncs  = 0;
+static uint16_t                      azoteq_iqs7211e_split_cpi           = 0;
+
+static int16_t azoteq_iqs7211e_split_clamp(int32_t value, int16_t limit) {
+    return value > limit ? limit : value < -limit ? -limit : value;
+}
+
+static void azoteq_iqs7211e_split_put16(uint8_t **cursor, int16_t value) {
+    *(*cursor)++ = value & 0xFF;
+    *(*cursor)++ = (uint16_t)value >> 8;
+}
+
+static int16_t azoteq_iqs7211e_split_get16(const uint8_t **cursor) {
+    int16_t value = (*cursor)[0] | ((*cursor)[1] << 8);
+    *cursor += 2;
+    return value;
+}
+
+// Packs everything that changed since the last frame; motion that does not
+// fit the field stays accumulated for the next one, so nothing is lost
+static void azoteq_iqs7211e_split_stage(void) {
+    uint8_t slot = azoteq_iqs7211e_split_deliver;
+    if (azoteq_iqs7211e_split_frame_length[slot] != 0) {
+        slot ^= 1;
+    }
+    if (azoteq_iqs7211e_split_frame_length[slot] != 0) {
+        return; // both frames still waiting for the master
+    }
+
+    bool    xy       = azoteq_iqs7211e_split_x != 0 || azoteq_iqs7211e_split_y != 0;
+    bool    vh       = azoteq_iqs7211e_split_v != 0 || azoteq_iqs7211e_split_h != 0;
+    bool    buttons  = azoteq_iqs7211e_split_buttons != azoteq_iqs7211e_split_staged_buttons || azoteq_iqs7211e_split_pressed != 0;
+    bool    keycodes = azoteq_iqs7211e_split_keycode_count != 0;
+    bool    ctrl     = azoteq_iqs7211e_split_ctrl != azoteq_iqs7211e_split_staged_ctrl;
+    uint8_t flags    = 0;
+
+    if (!xy && !vh && !buttons && !keycodes && !ctrl) {
+        return;
+    }
+
+    uint8_t *frame  = azoteq_iqs7211e_split_frame[slot];
+    uint8_t *cursor = &frame[1];
+
+    if (xy) {
+        int16_t x = azoteq_iqs7211e_split_clamp(azoteq_iqs7211e_split_x, INT16_MAX);
+        int16_t y = azoteq_iqs7211e_split_clamp(azoteq_iqs7211e_split_y, INT16_MAX);
+
+        flags |= 1 << AZOTEQ_IQS7211E_SPLIT_XY_BIT;
+        if (x < INT8_MIN || x > INT8_MAX || y < INT8_MIN || y > INT8_MAX) {
+            flags |= 1 << AZOTEQ_IQS7211E_SPLIT_WIDE_BIT;
+            azoteq_iqs7211e_split_put16(&cursor, x);
+            azoteq_iqs7211e_split_put16(&cursor, y);
+        } else {
+            *cursor++ = (uint8_t)x;
+            *cursor++ = (uint8_t)y;
+        }
+        azoteq_iqs7211e_split_x -= x;
+        azoteq_iqs7211e_split_y -= y;
+    }
+    if (vh) {
+        int8_t v = azoteq_iqs7211e_split_clamp(azoteq_iqs7211e_split_v, INT8_MAX);
+        int8_t h = azoteq_iqs7211e_split_clamp(azoteq_iqs7211e_split_h, INT8_MAX);
+
+        flags |= 1 << AZOTEQ_IQS7211E_SPLIT_VH_BIT;
+        *cursor++ = (uint8_t)v;
+        *cursor++ = (uint8_t)h;
+        azoteq_iqs7211e_split_v -= v;
+        azoteq_iqs7211e_split_h -= h;
+    }
+    if (buttons) {
+        flags |= 1 << AZOTEQ_IQS7211E_SPLIT_BUTTONS_BIT;
+        *cursor++ = (azoteq_iqs7211e_split_buttons & 0x0F) | (azoteq_iqs7211e_split_pressed << 4);
+        azoteq_iqs7211e_split_staged_buttons = azoteq_iqs7211e_split_buttons;
+        azoteq_iqs7211e_split_pressed        = 0;
+    }
+    if (keycodes) {
+        flags |= 1 << AZOTEQ_IQS7211E_SPLIT_KEYCODES_BIT;
+        *cursor++ = azoteq_iqs7211e_split_keycode_count;
+        for (uint8_t i = 0; i < azoteq_iqs7211e_split_keycode_count; i++) {
+            azoteq_iqs7211e_split_put16(&cursor, azoteq_iqs7211e_split_keycodes[i]);
+        }
+        azoteq_iqs7211e_split_keycode_count = 0;
+    }
+    if (azoteq_iqs7211e_split_ctrl) {
+        flags |= 1 << AZOTEQ_IQS7211E_SPLIT_CTRL_BIT;
+    }
+    azoteq_iqs7211e_split_staged_ctrl = azoteq_iqs7211e_split_ctrl;
+
+    frame[0] = flags;
+    if (++azoteq_iqs7211e_split_sequence == 0) {
+        azoteq_iqs7211e_split_sequence = 1; // 0 is the master's "nothing received yet"
+    }
+    azoteq_iqs7211e_split_frame_sequence[slot] = azoteq_iqs7211e_split_sequence;
+    // Publish last: the handlers only look at a slot once its length is set,
+    // so the frame stores must not be moved past it
+    atomic_signal_fence(memory_order_release);
+    azoteq_iqs7211e_split_frame_length[slot] = cursor - frame;
+}
+
+static void azoteq_iqs7211e_split_query_handler(uint8_t in_buflen, const void *in_data, uint8_t out_buflen, void *out_data) {
+    const azoteq_iqs7211e_split_query_t *query  = in_data;
+    azoteq_iqs7211e_split_answer_t      *answer = out_data;
+
+    if (in_buflen < sizeof(*query) || out_buflen < sizeof(*answer)) {
+        return;
+    }
+
+    // Applied from the main loop, the handler may run in an interrupt
+    azoteq_iqs7211e_split_requested_cpi = query->cpi;
+
+    uint8_t slot = azoteq_iqs7211e_split_deliver;
+    if (azoteq_iqs7211e_split_frame_length[slot] != 0 && query->ack == azoteq_iqs7211e_split_frame_sequence[slot]) {
+        azoteq_iqs7211e_split_frame_length[slot] = 0;
+        azoteq_iqs7211e_split_deliver = slot ^= 1;
+    }
+
+    answer->version  = query->version < AZOTEQ_IQS7211E_SPLIT_VERSION ? query->version : AZOTEQ_IQS7211E_SPLIT_VERSION;
+    answer->sequence = azoteq_iqs7211e_split_frame_sequence[slot];
+    answer->length   = azoteq_iqs7211e_split_frame_length[slot];
+}
+
+static void azoteq_iqs7211e_split_fetch_handler(uint8_t in_buflen, const void *in_data, uint8_t out_buflen, void *out_data) {
+    memcpy(out_data, azoteq_iqs7211e_split_frame[azoteq_iqs7211e_split_deliver], out_buflen < AZOTEQ_IQS7211E_SPLIT_FRAME_MAX ? out_buflen : AZOTEQ_IQS7211E_SPLIT_FRAME_MAX);
+}
+
+void azoteq_iqs7211e_split_init(void) {
+    transaction_register_rpc(AZOTEQ_IQS7211E_SPLIT_QUERY, azoteq_iqs7211e_split_query_handler);
+    transaction_register_rpc(AZOTEQ_IQS7211E_SPLIT_FETCH, azoteq_iqs7211e_split_fetch_handler);
+}
+
+// Peripheral, once per pointing task
+void azoteq_iqs7211e_split_send(azoteq_iqs7211e_motion_t motion) {
+    uint16_t cpi = azoteq_iqs7211e_split_requested_cpi;
+    if (cpi != 0 && cpi != azoteq_iqs7211e_units.cpi) {
+        azoteq_iqs7211e_set_cpi(cpi);
+    }
+
+    azoteq_iqs7211e_split_x += motion.x;
+    azoteq_iqs7211e_split_y += motion.y;
+    azoteq_iqs7211e_split_v = azoteq_iqs7211e_split_clamp((int32_t)azoteq_iqs7211e_split_v + motion.v, INT16_MAX);
+    azoteq_iqs7211e_split_h = azoteq_iqs7211e_split_clamp((int32_t)azoteq_iqs7211e_split_h + motion.h, INT16_MAX);
+    azoteq_iqs7211e_split_pressed |= motion.buttons & ~azoteq_iqs7211e_split_buttons;
+    azoteq_iqs7211e_split_buttons = motion.buttons;
+
+    azoteq_iqs7211e_split_stage();
+}
+
+void azoteq_iqs7211e_split_hold_ctrl(bool held) {
+    azoteq_iqs7211e_split_ctrl = held;
+}
+
+void azoteq_iqs7211e_split_tap_keycode(uint16_t keycode) {
+    if (azoteq_iqs7211e_split_keycode_count < AZOTEQ_IQS7211E_SPLIT_KEYCODES) {
+        azoteq_iqs7211e_split_keycodes[azoteq_iqs7211e_split_keycode_count++] = keycode;
+    }
+}
+
+static void azoteq_iqs7211e_split_decode(const uint8_t *frame) {
+    const uint8_t *cursor = &frame[1];
+    uint8_t        flags  = frame[0];
+
+    if (flags & (1 << AZOTEQ_IQS7211E_SPLIT_XY_BIT)) {
+        if (flags & (1 << AZOTEQ_IQS7211E_SPLIT_WIDE_BIT)) {
+            azoteq_iqs7211e_split_motion.x += azoteq_iqs7211e_split_get16(&cursor);
+            azoteq_iqs7211e_split_motion.y += azoteq_iqs7211e_split_get16(&cursor);
+        } else {
+            azoteq_iqs7211e_split_motion.x += (int8_t)*cursor++;
+            azoteq_iqs7211e_split_motion.y += (int8_t)*cursor++;
+        }
+    }
+    if (flags & (1 << AZOTEQ_IQS7211E_SPLIT_VH_BIT)) {
+        azoteq_iqs7211e_split_motion.v += (int8_t)*cursor++;
+        azoteq_iqs7211e_split_motion.h += (int8_t)*cursor++;
+    }
+    if (flags & (1 << AZOTEQ_IQS7211E_SPLIT_BUTTONS_BIT)) {
+        uint8_t buttons = *cursor++;
+        azoteq_iqs7211e_split_motion.buttons = buttons & 0x0F;
+        // A click shorter than the sync interval still reaches the host once
+        azoteq_iqs7211e_split_button_pulse |= (buttons >> 4) & ~azoteq_iqs7211e_split_motion.buttons;
+    }
+    if (flags & (1 << AZOTEQ_IQS7211E_SPLIT_KEYCODES_BIT)) {
+        for (uint8_t count = *cursor++; count > 0; count--) {
+            tap_code16(azoteq_iqs7211e_split_get16(&cursor));
+        }
+    }
+    bool ctrl = flags & (1 << AZOTEQ_IQS7211E_SPLIT_CTRL_BIT);
+    if (ctrl != azoteq_iqs7211e_split_master_ctrl) {
+        azoteq_iqs7211e_split_master_ctrl = ctrl;
+        if (ctrl) {
+            register_mods(MOD_BIT(KC_LCTL));
+        } else {
+            unregister_mods(MOD_BIT(KC_LCTL));
+        }
+    }
+}
+
+static void azoteq_iqs7211e_split_sync(void) {
+    azoteq_iqs7211e_split_query_t  query  = {AZOTEQ_IQS7211E_SPLIT_VERSION, azoteq_iqs7211e_split_received, azoteq_iqs7211e_split_cpi};
+    azoteq_iqs7211e_split_answer_t answer = {0};
+    uint8_t                        frame[AZOTEQ_IQS7211E_SPLIT_FRAME_MAX];
+
+    azoteq_iqs7211e_split_window_syncs++;
+    if (!transaction_rpc_exec(AZOTEQ_IQS7211E_SPLIT_QUERY, sizeof(query), &query, sizeof(answer), &answer)) {
+        return;
+    }
+    azoteq_iqs7211e_split_window_bytes += sizeof(query) + sizeof(answer);
+
+    // Version 1 is the only format so far; 0 means the peripheral speaks none we know
+    if (answer.version == 0 || answer.length == 0 || answer.length > sizeof(frame) || answer.sequence == azoteq_iqs7211e_split_received) {
+        return;
+    }
+    if (!transaction_rpc_exec(AZOTEQ_IQS7211E_SPLIT_FETCH, sizeof(answer.sequence), &answer.sequence, answer.length, frame)) {
+        return; // not acknowledged, the peripheral keeps the frame for the next sync
+    }
+    azoteq_iqs7211e_split_window_bytes += sizeof(answer.sequence) + answer.length;
+
+    azoteq_iqs7211e_split_decode(frame);
+    azoteq_iqs7211e_split_received = answer.sequence;
+    azoteq_iqs7211e_split_stats.frames++;
+}
+
+// Master, once per pointing task
+azoteq_iqs7211e_motion_t azoteq_iqs7211e_split_receive(void) {
+    if (timer_elapsed32(azoteq_iqs7211e_split_sync_time) >= AZOTEQ_IQS7211E_SPLIT_SYNC_MS) {
+        azoteq_iqs7211e_split_sync_time = timer_read32();
+        azoteq_iqs7211e_split_sync();
+    }
+
+    if (timer_elapsed32(azoteq_iqs7211e_split_window_time) >= 1000) {
+        uint32_t full = (uint32_t)azoteq_iqs7211e_split_window_syncs * sizeof(report_mouse_t);
+
+        azoteq_iqs7211e_split_stats.bytes += azoteq_iqs7211e_split_window_bytes;
+        azoteq_iqs7211e_split_stats.bytes_saved_per_second = full > azoteq_iqs7211e_split_window_bytes ? full - azoteq_iqs7211e_split_window_bytes : 0;
+        azoteq_iqs7211e_split_window_time                  = timer_read32();
+        azoteq_iqs7211e_split_window_bytes                 = 0;
+        azoteq_iqs7211e_split_window_syncs                 = 0;
+    }
+
+    azoteq_iqs7211e_motion_t motion = azoteq_iqs7211e_split_motion;
+    motion.buttons |= azoteq_iqs7211e_split_button_pulse;
+
+    azoteq_iqs7211e_split_button_pulse = 0;
+    azoteq_iqs7211e_split_motion.x     = 0;
+    azoteq_iqs7211e_split_motion.y     = 0;
+    azoteq_iqs7211e_split_motion.v     = 0;
+    azoteq_iqs7211e_split_motion.h     = 0;
+    return motion;
+}
+
+// Master: the peripheral picks the new CPI up with the next sync
+void azoteq_iqs7211e_split_set_cpi(uint16_t cpi) {
+    azoteq_iqs7211e_split_cpi = cpi;
+}
+
+void azoteq_iqs7211e_split_get_stats(azoteq_iqs7211e_split_stats_t *stats) {
+    *stats = azoteq_iqs7211e_split_stats;
+}
+
+#endif
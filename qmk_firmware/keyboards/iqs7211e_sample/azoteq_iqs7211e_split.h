@@ -0,0 +1,80 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "azoteq_iqs7211e.h"
+
+// Compact transport for split builds with the pad on the peripheral half.
+// Enable with AZOTEQ_IQS7211E_SPLIT_ENABLE instead of SPLIT_POINTING_ENABLE
+// and reserve the transactions in config.h:
+//
+//   #define SPLIT_TRANSACTION_IDS_KB AZOTEQ_IQS7211E_SPLIT_QUERY, AZOTEQ_IQS7211E_SPLIT_FETCH
+//
+// The peripheral coalesces motion, buttons and gesture key output into a
+// packed delta frame, staged only when something changed and kept until the
+// master acknowledges it. The master polls once per sync interval: a query
+// that acknowledges the last frame, carries the CPI set on the master and
+// returns the size of the next frame, then a fetch only when a new frame is
+// staged.
+//
+// The sensor, its tunables, the event log and the diagnostics all live on
+// the peripheral, while VIA and raw HID commands arrive at the master, so
+// the runtime tuning interface is not available in split builds.
+
+#if defined(AZOTEQ_IQS7211E_SPLIT_ENABLE) && (defined(VIA_ENABLE) || defined(RAW_ENABLE))
+#    error "AZOTEQ_IQS7211E_SPLIT_ENABLE cannot be combined with VIA_ENABLE or RAW_ENABLE: the tunables are on the peripheral"
+#endif
+
+// Time between two split syncs on the master
+#ifndef AZOTEQ_IQS7211E_SPLIT_SYNC_MS
+#    define AZOTEQ_IQS7211E_SPLIT_SYNC_MS 5
+#endif
+
+// Gesture keycode taps carried in one frame; later taps wait for the next
+#ifndef AZOTEQ_IQS7211E_SPLIT_KEYCODES
+#    define AZOTEQ_IQS7211E_SPLIT_KEYCODES 4
+#endif
+
+// Highest frame format this side speaks; both sides use the lower one
+#define AZOTEQ_IQS7211E_SPLIT_VERSION 1
+
+// Frame: flags, then only the fields the flags announce
+#define AZOTEQ_IQS7211E_SPLIT_XY_BIT 0       // x, y as int8, or int16 with WIDE
+#define AZOTEQ_IQS7211E_SPLIT_VH_BIT 1       // v, h as int8
+#define AZOTEQ_IQS7211E_SPLIT_BUTTONS_BIT 2  // state in the low, presses since the last frame in the high nibble
+#define AZOTEQ_IQS7211E_SPLIT_KEYCODES_BIT 3 // count, then little-endian keycodes
+#define AZOTEQ_IQS7211E_SPLIT_WIDE_BIT 4     // x, y did not fit int8
+#define AZOTEQ_IQS7211E_SPLIT_CTRL_BIT 5     // Ctrl held for pinch and rotate
+
+#define AZOTEQ_IQS7211E_SPLIT_FRAME_MAX (1 + 4 + 2 + 1 + 1 + AZOTEQ_IQS7211E_SPLIT_KEYCODES * 2)
+
+typedef struct {
+    uint32_t frames;                 // frames received by the master
+    uint32_t bytes;                  // bytes moved over the split link, both directions
+    uint16_t bytes_saved_per_second; // against a full report_mouse_t every sync
+} azoteq_iqs7211e_split_stats_t;
+
+void                     azoteq_iqs7211e_split_init(void);
+void                     azoteq_iqs7211e_split_send(azoteq_iqs7211e_motion_t motion);
+azoteq_iqs7211e_motion_t azoteq_iqs7211e_split_receive(void);
+void                     azoteq_iqs7211e_split_hold_ctrl(bool held);
+void                     azoteq_iqs7211e_split_tap_keycode(uint16_t keycode);
+void                     azoteq_iqs7211e_split_set_cpi(uint16_t cpi);
+void                     azoteq_iqs7211e_split_get_stats(azoteq_iqs7211e_split_stats_t *stats);
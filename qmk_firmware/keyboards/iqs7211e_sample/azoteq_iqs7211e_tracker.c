@@ -0,0 +1,124 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_tracker.h"
+
+#define AZOTEQ_IQS7211E_TRACK_GATE ((int32_t)AZOTEQ_IQS7211E_TRACK_MAX_JUMP * AZOTEQ_IQS7211E_TRACK_MAX_JUMP)
+
+// Squared distance to an active slot, or the gate cost when the point would start a new contact
+static int32_t azoteq_iqs7211e_tracker_cost(const azoteq_iqs7211e_contact_t *contact, uint16_t x, uint16_t y) {
+    if (!contact->active) {
+        return AZOTEQ_IQS7211E_TRACK_GATE;
+    }
+
+    int32_t dx = (int32_t)x - contact->raw_x;
+    int32_t dy = (int32_t)y - contact->raw_y;
+    int32_t d2 = dx * dx + dy * dy;
+    return d2 < AZOTEQ_IQS7211E_TRACK_GATE ? d2 : AZOTEQ_IQS7211E_TRACK_GATE;
+}
+
+void azoteq_iqs7211e_tracker_update(azoteq_iqs7211e_tracker_t *tracker, uint8_t count, const uint16_t x[], const uint16_t y[], uint16_t dt_ms) {
+    // Nearest-neighbour assignment of reported points to slots, point order either straight or swapped
+    static const uint8_t permutation[2][AZOTEQ_IQS7211E_MAX_CONTACTS] = {{0, 1}, {1, 0}};
+    int8_t               slot_point[AZOTEQ_IQS7211E_MAX_CONTACTS]     = {-1, -1};
+    uint8_t              best                                         = 0;
+    int32_t              best_cost                                    = INT32_MAX;
+
+    if (count > AZOTEQ_IQS7211E_MAX_CONTACTS) {
+        count = AZOTEQ_IQS7211E_MAX_CONTACTS;
+    }
+
+    for (uint8_t p = 0; p < 2; p++) {
+        int32_t cost = 0;
+        for (uint8_t point = 0; point < count; point++) {
+            cost += azoteq_iqs7211e_tracker_cost(&tracker->contact[permutation[p][point]], x[point], y[point]);
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best      = p;
+        }
+    }
+
+    for (uint8_t point = 0; point < count; point++) {
+        slot_point[permutation[best][point]] = point;
+    }
+
+    for (uint8_t slot = 0; slot < AZOTEQ_IQS7211E_MAX_CONTACTS; slot++) {
+        azoteq_iqs7211e_contact_t *contact = &tracker->contact[slot];
+        int8_t                     point   = slot_point[slot];
+
+        if (point < 0) {
+            // Lifted; the last position is kept for touch end handling
+            contact->active    = false;
+            contact->persisted = false;
+            contact->dx        = 0;
+            contact->dy        = 0;
+            continue;
+        }
+
+        uint16_t new_x = x[point];
+        uint16_t new_y = y[point];
+        bool     same  = azoteq_iqs7211e_tracker_cost(contact, new_x, new_y) < AZOTEQ_IQS7211E_TRACK_GATE;
+
+        contact->raw_x = new_x;
+        contact->raw_y = new_y;
+
+        if (same) {
+#ifdef AZOTEQ_IQS7211E_FILTER_ENABLE
+            // Smooth per contact before deltas are taken
+            azoteq_iqs7211e_filter_update(&contact->filter, &new_x, &new_y, dt_ms);
+#endif
+            contact->persisted = true;
+            contact->dx        = (int16_t)(new_x - contact->x);
+            contact->dy        = (int16_t)(new_y - contact->y);
+        } else {
+            // New finger, or a jump too large to be the same one
+#ifdef AZOTEQ_IQS7211E_FILTER_ENABLE
+            azoteq_iqs7211e_filter_reset(&contact->filter, new_x, new_y);
+#endif
+            contact->persisted = false;
+            contact->id        = tracker->next_id++;
+            contact->dx        = 0;
+            contact->dy        = 0;
+        }
+
+        contact->active = true;
+        contact->x      = new_x;
+        contact->y      = new_y;
+    }
+
+    tracker->count = count;
+}
+
+const azoteq_iqs7211e_contact_t *azoteq_iqs7211e_tracker_primary(const azoteq_iqs7211e_tracker_t *tracker) {
+    for (uint8_t slot = 0; slot < AZOTEQ_IQS7211E_MAX_CONTACTS; slot++) {
+        if (tracker->contact[slot].active) {
+            return &tracker->contact[slot];
+        }
+    }
+    return &tracker->contact[0];
+}
+
+bool azoteq_iqs7211e_tracker_settled(const azoteq_iqs7211e_tracker_t *tracker) {
+    for (uint8_t slot = 0; slot < AZOTEQ_IQS7211E_MAX_CONTACTS; slot++) {
+        const azoteq_iqs7211e_contact_t *contact = &tracker->contact[slot];
+        if (contact->active && (contact->x != contact->raw_x || contact->y != contact->raw_y)) {
+            return false;
+        }
+    }
+    return true;
+}
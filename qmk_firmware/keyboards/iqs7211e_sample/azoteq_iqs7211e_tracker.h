@@ -0,0 +1,56 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "azoteq_iqs7211e_filter.h"
+
+#define AZOTEQ_IQS7211E_MAX_CONTACTS 2
+
+// Largest per-frame movement, in sensor counts, still treated as the same finger
+#ifndef AZOTEQ_IQS7211E_TRACK_MAX_JUMP
+#    define AZOTEQ_IQS7211E_TRACK_MAX_JUMP 300
+#endif
+
+typedef struct {
+    bool     active;
+    bool     persisted; // matched to a contact of the previous frame
+    uint8_t  id;
+    uint16_t raw_x; // as reported, used for matching
+    uint16_t raw_y;
+    uint16_t x; // smoothed when AZOTEQ_IQS7211E_FILTER_ENABLE is defined
+    uint16_t y;
+    int16_t  dx;
+    int16_t  dy;
+#ifdef AZOTEQ_IQS7211E_FILTER_ENABLE
+    azoteq_iqs7211e_filter_t filter;
+#endif
+} azoteq_iqs7211e_contact_t;
+
+// Contacts keep their slot for their whole lifetime, regardless of the sensor's finger order
+typedef struct {
+    azoteq_iqs7211e_contact_t contact[AZOTEQ_IQS7211E_MAX_CONTACTS];
+    uint8_t                   count;
+    uint8_t                   next_id;
+} azoteq_iqs7211e_tracker_t;
+
+void                             azoteq_iqs7211e_tracker_update(azoteq_iqs7211e_tracker_t *tracker, uint8_t count, const uint16_t x[], const uint16_t y[], uint16_t dt_ms);
+const azoteq_iqs7211e_contact_t *azoteq_iqs7211e_tracker_primary(const azoteq_iqs7211e_tracker_t *tracker);
+// False while a smoothed contact still trails the reported position
+bool                             azoteq_iqs7211e_tracker_settled(const azoteq_iqs7211e_tracker_t *tracker);
@@ -0,0 +1,116 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Mounting orientation. All of these are resolved at compile time; with none
+// defined the transform compiles to nothing.
+//
+// AZOTEQ_IQS7211E_ROTATION  rotate motion clockwise on screen, in whole degrees 0 - 359.
+//                           Multiples of 90 become axis swaps and sign flips, any other
+//                           angle adds a Q14 rotation matrix for the remaining part.
+// AZOTEQ_IQS7211E_SWAP_XY   exchange the axes, applied after the rotation
+// AZOTEQ_IQS7211E_INVERT_X  negate x, applied last
+// AZOTEQ_IQS7211E_INVERT_Y  negate y, applied last
+#ifndef AZOTEQ_IQS7211E_ROTATION
+#    define AZOTEQ_IQS7211E_ROTATION 0
+#endif
+
+#if AZOTEQ_IQS7211E_ROTATION < 0 || AZOTEQ_IQS7211E_ROTATION >= 360
+#    error "AZOTEQ_IQS7211E_ROTATION must be between 0 and 359"
+#endif
+
+#define AZOTEQ_IQS7211E_ROTATION_QUADRANT (AZOTEQ_IQS7211E_ROTATION / 90)
+#define AZOTEQ_IQS7211E_ROTATION_FINE (AZOTEQ_IQS7211E_ROTATION % 90)
+
+#if AZOTEQ_IQS7211E_ROTATION_FINE != 0
+// sin and cos of the fine angle in Q14, from Taylor series that are exact to
+// well under one LSB on 0 - 90 degrees. Only used as constant initializers.
+#    define AZOTEQ_IQS7211E_ROTATION_RAD (AZOTEQ_IQS7211E_ROTATION_FINE * 3.14159265358979 / 180.0)
+#    define AZOTEQ_IQS7211E_ROTATION_RAD2 (AZOTEQ_IQS7211E_ROTATION_RAD * AZOTEQ_IQS7211E_ROTATION_RAD)
+#    define AZOTEQ_IQS7211E_ROTATION_SIN_Q14 ((int32_t)(16384.0 * AZOTEQ_IQS7211E_ROTATION_RAD * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 6 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 20 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 42 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 72 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 110))))) + 0.5))
+#    define AZOTEQ_IQS7211E_ROTATION_COS_Q14 ((int32_t)(16384.0 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 2 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 12 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 30 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 56 * (1 - AZOTEQ_IQS7211E_ROTATION_RAD2 / 90))))) + 0.5))
+#endif
+
+// Rotations keep the sense of turning, while each swap or inversion mirrors
+// it. Angles measured on sensor coordinates (rim scroll, rotate) are
+// multiplied by this to turn the same way as the transformed motion.
+#if (defined(AZOTEQ_IQS7211E_SWAP_XY) + defined(AZOTEQ_IQS7211E_INVERT_X) + defined(AZOTEQ_IQS7211E_INVERT_Y)) % 2
+#    define AZOTEQ_IQS7211E_TRANSFORM_HANDEDNESS (-1)
+#else
+#    define AZOTEQ_IQS7211E_TRANSFORM_HANDEDNESS 1
+#endif
+
+// Sub-count remainder of the rotation matrix, one per delta stream
+typedef struct {
+    int16_t x;
+    int16_t y;
+} azoteq_iqs7211e_transform_residue_t;
+
+static inline void azoteq_iqs7211e_transform(int16_t *x, int16_t *y, azoteq_iqs7211e_transform_residue_t *residue) {
+    int16_t tx = *x, ty = *y, t;
+
+    (void)t;
+    (void)residue;
+
+#if AZOTEQ_IQS7211E_ROTATION_FINE != 0
+    {
+        static const int32_t rot_sin = AZOTEQ_IQS7211E_ROTATION_SIN_Q14;
+        static const int32_t rot_cos = AZOTEQ_IQS7211E_ROTATION_COS_Q14;
+
+        // Carry the remainder so slow motion is not rounded away
+        int32_t rx = (int32_t)tx * rot_cos - (int32_t)ty * rot_sin + residue->x;
+        int32_t ry = (int32_t)tx * rot_sin + (int32_t)ty * rot_cos + residue->y;
+
+        tx         = (rx + (1 << 13)) >> 14;
+        ty         = (ry + (1 << 13)) >> 14;
+        residue->x  = rx - ((int32_t)tx << 14);
+        residue->y  = ry - ((int32_t)ty << 14);
+    }
+#endif
+
+    // Sensor y grows downwards, so a clockwise quarter turn maps (x, y) to (-y, x)
+#if AZOTEQ_IQS7211E_ROTATION_QUADRANT == 1
+    t  = tx;
+    tx = -ty;
+    ty = t;
+#elif AZOTEQ_IQS7211E_ROTATION_QUADRANT == 2
+    tx = -tx;
+    ty = -ty;
+#elif AZOTEQ_IQS7211E_ROTATION_QUADRANT == 3
+    t  = tx;
+    tx = ty;
+    ty = -t;
+#endif
+
+#ifdef AZOTEQ_IQS7211E_SWAP_XY
+    t  = tx;
+    tx = ty;
+    ty = t;
+#endif
+#ifdef AZOTEQ_IQS7211E_INVERT_X
+    tx = -tx;
+#endif
+#ifdef AZOTEQ_IQS7211E_INVERT_Y
+    ty = -ty;
+#endif
+
+    *x = tx;
+    *y = ty;
+}
@@ -0,0 +1,272 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_tunables.h"
+#include "azoteq_iqs7211e_diag.h"
+#include "azoteq_iqs7211e_log.h"
+#include "azoteq_iqs7211e_power.h"
+#include "IQS7211_init.h"
+#include <stddef.h>
+#include <string.h>
+
+#define AZOTEQ_IQS7211E_U16(l, h) ((uint16_t)((l) | ((h) << 8)))
+
+azoteq_iqs7211e_tunables_t azoteq_iqs7211e_tunables;
+
+static const azoteq_iqs7211e_tunables_t azoteq_iqs7211e_tunables_default = {
+    .magic                       = AZOTEQ_IQS7211E_TUNABLES_MAGIC,
+    .version                     = AZOTEQ_IQS7211E_TUNABLES_VERSION,
+    .tp_ati_target               = AZOTEQ_IQS7211E_U16(TP_ATI_TARGET_0, TP_ATI_TARGET_1),
+    .alp_ati_target              = AZOTEQ_IQS7211E_U16(ALP_ATI_TARGET_0, ALP_ATI_TARGET_1),
+    .active_mode_report_rate     = AZOTEQ_IQS7211E_U16(ACTIVE_MODE_REPORT_RATE_0, ACTIVE_MODE_REPORT_RATE_1),
+    .idle_touch_mode_report_rate = AZOTEQ_IQS7211E_U16(IDLE_TOUCH_MODE_REPORT_RATE_0, IDLE_TOUCH_MODE_REPORT_RATE_1),
+    .idle_mode_report_rate       = AZOTEQ_IQS7211E_U16(IDLE_MODE_REPORT_RATE_0, IDLE_MODE_REPORT_RATE_1),
+    .lp1_mode_report_rate        = AZOTEQ_IQS7211E_U16(LP1_MODE_REPORT_RATE_0, LP1_MODE_REPORT_RATE_1),
+    .lp2_mode_report_rate        = AZOTEQ_IQS7211E_U16(LP2_MODE_REPORT_RATE_0, LP2_MODE_REPORT_RATE_1),
+    .active_mode_timeout         = AZOTEQ_IQS7211E_U16(ACTIVE_MODE_TIMEOUT_0, ACTIVE_MODE_TIMEOUT_1),
+    .idle_touch_mode_timeout     = AZOTEQ_IQS7211E_U16(IDLE_TOUCH_MODE_TIMEOUT_0, IDLE_TOUCH_MODE_TIMEOUT_1),
+    .idle_mode_timeout           = AZOTEQ_IQS7211E_U16(IDLE_MODE_TIMEOUT_0, IDLE_MODE_TIMEOUT_1),
+    .lp1_mode_timeout            = AZOTEQ_IQS7211E_U16(LP1_MODE_TIMEOUT_0, LP1_MODE_TIMEOUT_1),
+    .i2c_timeout                 = AZOTEQ_IQS7211E_U16(I2C_TIMEOUT_0, I2C_TIMEOUT_1),
+    .tp_touch_set_threshold      = TRACKPAD_TOUCH_SET_THRESHOLD,
+    .tp_touch_clear_threshold    = TRACKPAD_TOUCH_CLEAR_THRESHOLD,
+    .alp_threshold               = AZOTEQ_IQS7211E_U16(ALP_THRESHOLD_0, ALP_THRESHOLD_1),
+    .alp_set_debounce            = ALP_SET_DEBOUNCE,
+    .alp_clear_debounce          = ALP_CLEAR_DEBOUNCE,
+    .alp_count_beta_lp1          = ALP_COUNT_BETA_LP1,
+    .alp_lta_beta_lp1            = ALP_LTA_BETA_LP1,
+    .alp_count_beta_lp2          = ALP_COUNT_BETA_LP2,
+    .alp_lta_beta_lp2            = ALP_LTA_BETA_LP2,
+    .xy_filter_bottom_speed      = AZOTEQ_IQS7211E_U16(XY_DYNAMIC_FILTER_BOTTOM_SPEED_0, XY_DYNAMIC_FILTER_BOTTOM_SPEED_1),
+    .xy_filter_top_speed         = AZOTEQ_IQS7211E_U16(XY_DYNAMIC_FILTER_TOP_SPEED_0, XY_DYNAMIC_FILTER_TOP_SPEED_1),
+    .xy_filter_bottom_beta       = XY_DYNAMIC_FILTER_BOTTOM_BETA,
+    .xy_static_filter_beta       = XY_DYNAMIC_FILTER_STATIC_FILTER_BETA,
+    .stationary_touch_threshold  = STATIONARY_TOUCH_MOV_THRESHOLD,
+    .tap_touch_time              = AZOTEQ_IQS7211E_U16(TAP_TOUCH_TIME_0, TAP_TOUCH_TIME_1),
+    .tap_wait_time               = AZOTEQ_IQS7211E_U16(TAP_WAIT_TIME_0, TAP_WAIT_TIME_1),
+    .tap_distance                = AZOTEQ_IQS7211E_U16(TAP_DISTANCE_0, TAP_DISTANCE_1),
+    .hold_time                   = AZOTEQ_IQS7211E_U16(HOLD_TIME_0, HOLD_TIME_1),
+    .swipe_time                  = AZOTEQ_IQS7211E_U16(SWIPE_TIME_0, SWIPE_TIME_1),
+    .swipe_x_distance            = AZOTEQ_IQS7211E_U16(SWIPE_X_DISTANCE_0, SWIPE_X_DISTANCE_1),
+    .swipe_y_distance            = AZOTEQ_IQS7211E_U16(SWIPE_Y_DISTANCE_0, SWIPE_Y_DISTANCE_1),
+    .palm_threshold              = PALM_THRESHOLD,
+};
+
+typedef struct {
+    uint8_t offset;
+    uint8_t size;
+    uint8_t block;
+    bool    needs_ati;
+} azoteq_iqs7211e_tunable_desc_t;
+
+#define TUNABLE(field, blk, ati) \
+    { offsetof(azoteq_iqs7211e_tunables_t, field), sizeof(((azoteq_iqs7211e_tunables_t *)0)->field), AZOTEQ_IQS7211E_BLOCK_##blk, ati }
+
+static const azoteq_iqs7211e_tunable_desc_t azoteq_iqs7211e_tunable_desc[AZOTEQ_IQS7211E_TUNABLE_COUNT] = {
+    [AZOTEQ_IQS7211E_TUNABLE_TP_ATI_TARGET]               = TUNABLE(tp_ati_target, ATI, true),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_ATI_TARGET]              = TUNABLE(alp_ati_target, ATI, true),
+    [AZOTEQ_IQS7211E_TUNABLE_ACTIVE_MODE_REPORT_RATE]     = TUNABLE(active_mode_report_rate, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_IDLE_TOUCH_MODE_REPORT_RATE] = TUNABLE(idle_touch_mode_report_rate, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_IDLE_MODE_REPORT_RATE]       = TUNABLE(idle_mode_report_rate, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_LP1_MODE_REPORT_RATE]        = TUNABLE(lp1_mode_report_rate, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_LP2_MODE_REPORT_RATE]        = TUNABLE(lp2_mode_report_rate, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ACTIVE_MODE_TIMEOUT]         = TUNABLE(active_mode_timeout, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_IDLE_TOUCH_MODE_TIMEOUT]     = TUNABLE(idle_touch_mode_timeout, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_IDLE_MODE_TIMEOUT]           = TUNABLE(idle_mode_timeout, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_LP1_MODE_TIMEOUT]            = TUNABLE(lp1_mode_timeout, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_I2C_TIMEOUT]                 = TUNABLE(i2c_timeout, REPORT_RATES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_TP_TOUCH_SET_THRESHOLD]      = TUNABLE(tp_touch_set_threshold, THRESHOLDS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_TP_TOUCH_CLEAR_THRESHOLD]    = TUNABLE(tp_touch_clear_threshold, THRESHOLDS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_THRESHOLD]               = TUNABLE(alp_threshold, THRESHOLDS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_SET_DEBOUNCE]            = TUNABLE(alp_set_debounce, THRESHOLDS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_CLEAR_DEBOUNCE]          = TUNABLE(alp_clear_debounce, THRESHOLDS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_COUNT_BETA_LP1]          = TUNABLE(alp_count_beta_lp1, FILTER_BETAS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_LTA_BETA_LP1]            = TUNABLE(alp_lta_beta_lp1, FILTER_BETAS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_COUNT_BETA_LP2]          = TUNABLE(alp_count_beta_lp2, FILTER_BETAS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_ALP_LTA_BETA_LP2]            = TUNABLE(alp_lta_beta_lp2, FILTER_BETAS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_BOTTOM_SPEED]      = TUNABLE(xy_filter_bottom_speed, TP_SETTINGS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_TOP_SPEED]         = TUNABLE(xy_filter_top_speed, TP_SETTINGS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_BOTTOM_BETA]       = TUNABLE(xy_filter_bottom_beta, TP_SETTINGS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_XY_STATIC_FILTER_BETA]       = TUNABLE(xy_static_filter_beta, TP_SETTINGS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_STATIONARY_TOUCH_THRESHOLD]  = TUNABLE(stationary_touch_threshold, TP_SETTINGS, false),
+    [AZOTEQ_IQS7211E_TUNABLE_TAP_TOUCH_TIME]              = TUNABLE(tap_touch_time, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_TAP_WAIT_TIME]               = TUNABLE(tap_wait_time, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_TAP_DISTANCE]                = TUNABLE(tap_distance, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_HOLD_TIME]                   = TUNABLE(hold_time, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_SWIPE_TIME]                  = TUNABLE(swipe_time, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_SWIPE_X_DISTANCE]            = TUNABLE(swipe_x_distance, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_SWIPE_Y_DISTANCE]            = TUNABLE(swipe_y_distance, GESTURES, false),
+    [AZOTEQ_IQS7211E_TUNABLE_PALM_THRESHOLD]              = TUNABLE(palm_threshold, GESTURES, false),
+};
+
+// One bit per azoteq_iqs7211e_block_t that has to be rewritten
+static uint16_t azoteq_iqs7211e_dirty_blocks = 0;
+static uint16_t azoteq_iqs7211e_ati_blocks   = 0;
+
+void azoteq_iqs7211e_tunables_init(void) {
+    uint8_t buffer[AZOTEQ_IQS7211E_STORAGE_SIZE];
+    if (azoteq_iqs7211e_storage_read(buffer)) {
+        memcpy(&azoteq_iqs7211e_tunables, buffer, sizeof(azoteq_iqs7211e_tunables));
+    } else {
+        azoteq_iqs7211e_tunables.magic = 0;
+    }
+
+    if (azoteq_iqs7211e_tunables.magic != AZOTEQ_IQS7211E_TUNABLES_MAGIC || azoteq_iqs7211e_tunables.version != AZOTEQ_IQS7211E_TUNABLES_VERSION) {
+        dprintf("IQS7211E: Tunables invalid, loading defaults\n");
+        azoteq_iqs7211e_tunables = azoteq_iqs7211e_tunables_default;
+        azoteq_iqs7211e_tunables_save();
+    }
+
+    azoteq_iqs7211e_dirty_blocks = 0;
+    azoteq_iqs7211e_ati_blocks   = 0;
+}
+
+void azoteq_iqs7211e_tunables_reset(void) {
+    for (uint8_t id = 0; id < AZOTEQ_IQS7211E_TUNABLE_COUNT; id++) {
+        const azoteq_iqs7211e_tunable_desc_t *desc = &azoteq_iqs7211e_tunable_desc[id];
+        uint16_t                              value = 0;
+        memcpy(&value, (const uint8_t *)&azoteq_iqs7211e_tunables_default + desc->offset, desc->size);
+        azoteq_iqs7211e_tunables_set(id, value);
+    }
+}
+
+void azoteq_iqs7211e_tunables_save(void) {
+    uint8_t buffer[AZOTEQ_IQS7211E_STORAGE_SIZE] = {0};
+    memcpy(buffer, &azoteq_iqs7211e_tunables, sizeof(azoteq_iqs7211e_tunables));
+    azoteq_iqs7211e_storage_write(buffer);
+}
+
+uint16_t azoteq_iqs7211e_tunables_get(azoteq_iqs7211e_tunable_id_t id) {
+    if (id >= AZOTEQ_IQS7211E_TUNABLE_COUNT) {
+        return 0;
+    }
+
+    const azoteq_iqs7211e_tunable_desc_t *desc  = &azoteq_iqs7211e_tunable_desc[id];
+    uint16_t                              value = 0;
+    memcpy(&value, (const uint8_t *)&azoteq_iqs7211e_tunables + desc->offset, desc->size);
+    return value;
+}
+
+bool azoteq_iqs7211e_tunables_set(azoteq_iqs7211e_tunable_id_t id, uint16_t value) {
+    if (id >= AZOTEQ_IQS7211E_TUNABLE_COUNT) {
+        return false;
+    }
+
+    const azoteq_iqs7211e_tunable_desc_t *desc = &azoteq_iqs7211e_tunable_desc[id];
+    if (desc->size == 1 && value > 0xFF) {
+        return false;
+    }
+
+    if (azoteq_iqs7211e_tunables_get(id) != value) {
+        memcpy((uint8_t *)&azoteq_iqs7211e_tunables + desc->offset, &value, desc->size);
+        azoteq_iqs7211e_dirty_blocks |= (1 << desc->block);
+        if (desc->needs_ati) {
+            azoteq_iqs7211e_ati_blocks |= (1 << desc->block);
+        }
+    }
+
+    return true;
+}
+
+void azoteq_iqs7211e_tunables_apply_pending(void) {
+    if (azoteq_iqs7211e_dirty_blocks == 0) {
+        return;
+    }
+
+    uint8_t block = 0;
+    while (!(azoteq_iqs7211e_dirty_blocks & (1 << block))) {
+        block++;
+    }
+
+    i2c_status_t status = azoteq_iqs7211e_write_block(block);
+    if (status != I2C_STATUS_SUCCESS) {
+        // Keep the block dirty and retry on the next frame
+        AZOTEQ_IQS7211E_LOG(TUNABLE_WRITE_FAILED, block, status);
+        return;
+    }
+
+    azoteq_iqs7211e_dirty_blocks &= ~(1 << block);
+    if (azoteq_iqs7211e_ati_blocks & (1 << block)) {
+        // Recalibrate once the pad is free, frames are discarded while ATI settles
+        azoteq_iqs7211e_ati_blocks &= ~(1 << block);
+        azoteq_iqs7211e_request_reati();
+    }
+}
+
+// Packet layout shared by the VIA custom channel and plain raw HID:
+// [0] command id, [1] channel id, [2] value id, [3] value high, [4] value low.
+// Value ids below AZOTEQ_IQS7211E_TUNABLE_COUNT are tunables; the diagnostic
+// modules own ids from 0x80 and lay out the bytes from [3] themselves. Only
+// the three custom value commands are used, VIA keeps every other command id.
+bool azoteq_iqs7211e_tunables_command(uint8_t *data, uint8_t length) {
+    if (length < 5) {
+        return false;
+    }
+
+    uint8_t  command = data[0];
+    uint8_t  id      = data[2];
+    uint16_t value;
+
+    switch (command) {
+        case 0x07: // id_custom_set_value
+            switch (id) {
+#ifdef AZOTEQ_IQS7211E_DIAG_ENABLE
+                case AZOTEQ_IQS7211E_DIAG_VALUE_ID:
+                    azoteq_iqs7211e_diag_set_enabled(data[3] != 0);
+                    return true;
+#endif
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+                case AZOTEQ_IQS7211E_POWER_VALUE_ID:
+                    azoteq_iqs7211e_power_reset_stats();
+                    return true;
+#endif
+                default:
+                    value = (data[3] << 8) | data[4];
+                    return azoteq_iqs7211e_tunables_set(id, value);
+            }
+        case 0x08: // id_custom_get_value
+            switch (id) {
+#ifdef AZOTEQ_IQS7211E_DIAG_ENABLE
+                case AZOTEQ_IQS7211E_DIAG_VALUE_ID:
+                    data[3] = azoteq_iqs7211e_diag_is_enabled();
+                    return true;
+#endif
+#if AZOTEQ_IQS7211E_LOG_LEVEL > AZOTEQ_IQS7211E_LOG_NONE
+                case AZOTEQ_IQS7211E_LOG_VALUE_ID:
+                    return azoteq_iqs7211e_log_command(data, length);
+#endif
+#ifdef AZOTEQ_IQS7211E_POWER_STATS_ENABLE
+                case AZOTEQ_IQS7211E_POWER_VALUE_ID:
+                    return azoteq_iqs7211e_power_command(data, length);
+#endif
+                default:
+                    if (id >= AZOTEQ_IQS7211E_TUNABLE_COUNT) {
+                        return false;
+                    }
+                    value   = azoteq_iqs7211e_tunables_get(id);
+                    data[3] = value >> 8;
+                    data[4] = value & 0xFF;
+                    return true;
+            }
+        case 0x09: // id_custom_save
+            azoteq_iqs7211e_tunables_save();
+            return true;
+        default:
+            return false;
+    }
+}
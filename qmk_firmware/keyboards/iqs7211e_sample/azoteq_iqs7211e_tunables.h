@@ -0,0 +1,148 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "azoteq_iqs7211e_platform.h"
+
+// Bump when the layout of azoteq_iqs7211e_tunables_t changes; stored blocks
+// with a different version are discarded and replaced with the defaults.
+#define AZOTEQ_IQS7211E_TUNABLES_MAGIC 0x7211
+#define AZOTEQ_IQS7211E_TUNABLES_VERSION 1
+
+// Register blocks of the memory map, in the order they are written at init
+typedef enum {
+    AZOTEQ_IQS7211E_BLOCK_ALP_COMPENSATION = 0, // 0x1F - 0x20
+    AZOTEQ_IQS7211E_BLOCK_ATI,                  // 0x21 - 0x27
+    AZOTEQ_IQS7211E_BLOCK_REPORT_RATES,         // 0x28 - 0x32
+    AZOTEQ_IQS7211E_BLOCK_SYSTEM_CONTROL,       // 0x33 - 0x35
+    AZOTEQ_IQS7211E_BLOCK_ALP_SETUP,            // 0x36 - 0x37
+    AZOTEQ_IQS7211E_BLOCK_THRESHOLDS,           // 0x38 - 0x3A
+    AZOTEQ_IQS7211E_BLOCK_FILTER_BETAS,         // 0x3B - 0x3C
+    AZOTEQ_IQS7211E_BLOCK_HARDWARE,             // 0x3D - 0x40
+    AZOTEQ_IQS7211E_BLOCK_TP_SETTINGS,          // 0x41 - 0x49
+    AZOTEQ_IQS7211E_BLOCK_VERSION,              // 0x4A
+    AZOTEQ_IQS7211E_BLOCK_GESTURES,             // 0x4B - 0x55
+    AZOTEQ_IQS7211E_BLOCK_RX_TX_MAP,            // 0x56 - 0x5C
+    AZOTEQ_IQS7211E_BLOCK_CYCLES_0_9,           // 0x5D - 0x6B
+    AZOTEQ_IQS7211E_BLOCK_CYCLES_10_19,         // 0x6C - 0x7A
+    AZOTEQ_IQS7211E_BLOCK_CYCLE_20,             // 0x7B - 0x7C
+    AZOTEQ_IQS7211E_BLOCK_COUNT,
+} azoteq_iqs7211e_block_t;
+
+// Tunable identifiers, also used as VIA / raw HID value ids; ids from 0x80
+// belong to the diagnostic modules
+typedef enum {
+    AZOTEQ_IQS7211E_TUNABLE_TP_ATI_TARGET = 0,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_ATI_TARGET,
+    AZOTEQ_IQS7211E_TUNABLE_ACTIVE_MODE_REPORT_RATE,
+    AZOTEQ_IQS7211E_TUNABLE_IDLE_TOUCH_MODE_REPORT_RATE,
+    AZOTEQ_IQS7211E_TUNABLE_IDLE_MODE_REPORT_RATE,
+    AZOTEQ_IQS7211E_TUNABLE_LP1_MODE_REPORT_RATE,
+    AZOTEQ_IQS7211E_TUNABLE_LP2_MODE_REPORT_RATE,
+    AZOTEQ_IQS7211E_TUNABLE_ACTIVE_MODE_TIMEOUT,
+    AZOTEQ_IQS7211E_TUNABLE_IDLE_TOUCH_MODE_TIMEOUT,
+    AZOTEQ_IQS7211E_TUNABLE_IDLE_MODE_TIMEOUT,
+    AZOTEQ_IQS7211E_TUNABLE_LP1_MODE_TIMEOUT,
+    AZOTEQ_IQS7211E_TUNABLE_I2C_TIMEOUT,
+    AZOTEQ_IQS7211E_TUNABLE_TP_TOUCH_SET_THRESHOLD,
+    AZOTEQ_IQS7211E_TUNABLE_TP_TOUCH_CLEAR_THRESHOLD,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_THRESHOLD,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_SET_DEBOUNCE,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_CLEAR_DEBOUNCE,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_COUNT_BETA_LP1,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_LTA_BETA_LP1,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_COUNT_BETA_LP2,
+    AZOTEQ_IQS7211E_TUNABLE_ALP_LTA_BETA_LP2,
+    AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_BOTTOM_SPEED,
+    AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_TOP_SPEED,
+    AZOTEQ_IQS7211E_TUNABLE_XY_FILTER_BOTTOM_BETA,
+    AZOTEQ_IQS7211E_TUNABLE_XY_STATIC_FILTER_BETA,
+    AZOTEQ_IQS7211E_TUNABLE_STATIONARY_TOUCH_THRESHOLD,
+    AZOTEQ_IQS7211E_TUNABLE_TAP_TOUCH_TIME,
+    AZOTEQ_IQS7211E_TUNABLE_TAP_WAIT_TIME,
+    AZOTEQ_IQS7211E_TUNABLE_TAP_DISTANCE,
+    AZOTEQ_IQS7211E_TUNABLE_HOLD_TIME,
+    AZOTEQ_IQS7211E_TUNABLE_SWIPE_TIME,
+    AZOTEQ_IQS7211E_TUNABLE_SWIPE_X_DISTANCE,
+    AZOTEQ_IQS7211E_TUNABLE_SWIPE_Y_DISTANCE,
+    AZOTEQ_IQS7211E_TUNABLE_PALM_THRESHOLD,
+    AZOTEQ_IQS7211E_TUNABLE_COUNT,
+} azoteq_iqs7211e_tunable_id_t;
+
+// Persisted tunables block. Multi-byte fields are stored in MCU byte order,
+// which matches the little-endian register layout of the IQS7211E.
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t  version;
+    uint8_t  reserved;
+    // ATI block (0x21)
+    uint16_t tp_ati_target;
+    uint16_t alp_ati_target;
+    // Report rates block (0x28)
+    uint16_t active_mode_report_rate;
+    uint16_t idle_touch_mode_report_rate;
+    uint16_t idle_mode_report_rate;
+    uint16_t lp1_mode_report_rate;
+    uint16_t lp2_mode_report_rate;
+    uint16_t active_mode_timeout;
+    uint16_t idle_touch_mode_timeout;
+    uint16_t idle_mode_timeout;
+    uint16_t lp1_mode_timeout;
+    uint16_t i2c_timeout;
+    // Thresholds block (0x38)
+    uint8_t  tp_touch_set_threshold;
+    uint8_t  tp_touch_clear_threshold;
+    uint16_t alp_threshold;
+    uint8_t  alp_set_debounce;
+    uint8_t  alp_clear_debounce;
+    // Filter betas block (0x3B)
+    uint8_t alp_count_beta_lp1;
+    uint8_t alp_lta_beta_lp1;
+    uint8_t alp_count_beta_lp2;
+    uint8_t alp_lta_beta_lp2;
+    // Trackpad settings block (0x41)
+    uint16_t xy_filter_bottom_speed;
+    uint16_t xy_filter_top_speed;
+    uint8_t  xy_filter_bottom_beta;
+    uint8_t  xy_static_filter_beta;
+    uint8_t  stationary_touch_threshold;
+    // Gesture block (0x4B)
+    uint16_t tap_touch_time;
+    uint16_t tap_wait_time;
+    uint16_t tap_distance;
+    uint16_t hold_time;
+    uint16_t swipe_time;
+    uint16_t swipe_x_distance;
+    uint16_t swipe_y_distance;
+    uint8_t  palm_threshold;
+} azoteq_iqs7211e_tunables_t;
+
+_Static_assert(sizeof(azoteq_iqs7211e_tunables_t) <= AZOTEQ_IQS7211E_STORAGE_SIZE, "AZOTEQ_IQS7211E_STORAGE_SIZE too small for IQS7211E tunables");
+
+// Live tunables, used by the memory map writer
+extern azoteq_iqs7211e_tunables_t azoteq_iqs7211e_tunables;
+
+void     azoteq_iqs7211e_tunables_init(void);
+void     azoteq_iqs7211e_tunables_reset(void);
+void     azoteq_iqs7211e_tunables_save(void);
+bool     azoteq_iqs7211e_tunables_set(azoteq_iqs7211e_tunable_id_t id, uint16_t value);
+uint16_t azoteq_iqs7211e_tunables_get(azoteq_iqs7211e_tunable_id_t id);
+void     azoteq_iqs7211e_tunables_apply_pending(void);
+bool     azoteq_iqs7211e_tunables_command(uint8_t *data, uint8_t length);
@@ -0,0 +1,55 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "azoteq_iqs7211e_units.h"
+#include "azoteq_iqs7211e.h"
+#include "azoteq_iqs7211e_pinch.h"
+#include "azoteq_iqs7211e_noise.h"
+
+#define AZOTEQ_IQS7211E_PAD_SIZE_UM ((uint32_t)AZOTEQ_IQS7211E_PAD_SIZE_MM * 1000)
+
+azoteq_iqs7211e_units_t azoteq_iqs7211e_units = {
+    .cpi           = AZOTEQ_IQS7211E_CPI,
+    .pointer_scale = AZOTEQ_IQS7211E_UNITS_ONE,
+    .scroll_scale  = AZOTEQ_IQS7211E_UNITS_ONE,
+};
+
+static uint16_t azoteq_iqs7211e_units_counts(uint32_t um, uint16_t resolution) {
+    uint32_t counts = (um * resolution + AZOTEQ_IQS7211E_PAD_SIZE_UM / 2) / AZOTEQ_IQS7211E_PAD_SIZE_UM;
+    return counts > 0 ? counts : 1;
+}
+
+static uint16_t azoteq_iqs7211e_units_ratio(uint32_t numerator, uint32_t denominator) {
+    uint32_t ratio = (numerator + denominator / 2) / denominator;
+    return ratio > UINT16_MAX ? UINT16_MAX : ratio > 0 ? ratio : 1;
+}
+
+// Both resolutions span the pad diameter; their mean converts distances
+void azoteq_iqs7211e_units_update(uint16_t x_resolution, uint16_t y_resolution, uint16_t cpi) {
+    uint16_t resolution = ((uint32_t)x_resolution + y_resolution) / 2;
+
+    azoteq_iqs7211e_units.cpi = cpi;
+    // Sensor counts per inch are resolution * 25.4 / pad size in mm
+    azoteq_iqs7211e_units.pointer_scale    = azoteq_iqs7211e_units_ratio((uint32_t)cpi * AZOTEQ_IQS7211E_PAD_SIZE_MM * 10 * AZOTEQ_IQS7211E_UNITS_ONE, (uint32_t)resolution * 254);
+    azoteq_iqs7211e_units.scroll_scale     = azoteq_iqs7211e_units_ratio(AZOTEQ_IQS7211E_PAD_SIZE_UM * AZOTEQ_IQS7211E_UNITS_ONE, (uint32_t)resolution * AZOTEQ_IQS7211E_SCROLL_STEP_UM);
+    azoteq_iqs7211e_units.tap_distance     = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_TAP_DISTANCE_UM, resolution);
+    azoteq_iqs7211e_units.scroll_lock      = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_SCROLL_LOCK_UM, resolution);
+    azoteq_iqs7211e_units.pinch_lock       = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_PINCH_LOCK_UM, resolution);
+    azoteq_iqs7211e_units.rotate_lock      = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_ROTATE_LOCK_UM, resolution);
+    azoteq_iqs7211e_units.pinch_step       = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_PINCH_STEP_UM, resolution);
+    azoteq_iqs7211e_units.noise_stationary = azoteq_iqs7211e_units_counts(AZOTEQ_IQS7211E_NOISE_STATIONARY_UM, resolution);
+}
@@ -0,0 +1,71 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Motion thresholds are configured in micrometres of finger travel, so 30 mm
+// and 40 mm pads, or a changed resolution, behave the same. They are
+// converted to sensor counts once, at init and on every CPI change; the frame
+// path only compares and multiplies integers.
+
+// Finger travel below which a short touch still counts as a tap
+#ifndef AZOTEQ_IQS7211E_TAP_DISTANCE_UM
+#    define AZOTEQ_IQS7211E_TAP_DISTANCE_UM 1500
+#endif
+
+// Two-finger travel per scroll wheel unit
+#ifndef AZOTEQ_IQS7211E_SCROLL_STEP_UM
+#    define AZOTEQ_IQS7211E_SCROLL_STEP_UM 30
+#endif
+
+// Pointer resolution reported to the host, in counts per inch
+#ifndef AZOTEQ_IQS7211E_CPI
+#    define AZOTEQ_IQS7211E_CPI 847
+#endif
+
+// Thresholds in sensor counts and scales in Q8, derived from the settings above
+typedef struct {
+    uint16_t cpi;
+    uint16_t pointer_scale; // output counts per sensor count
+    uint16_t scroll_scale;  // wheel units per sensor count
+    uint16_t tap_distance;
+    uint16_t scroll_lock;
+    uint16_t pinch_lock;
+    uint16_t rotate_lock;
+    uint16_t pinch_step;
+    uint16_t noise_stationary;
+} azoteq_iqs7211e_units_t;
+
+#define AZOTEQ_IQS7211E_UNITS_ONE 256
+
+extern azoteq_iqs7211e_units_t azoteq_iqs7211e_units;
+
+void azoteq_iqs7211e_units_update(uint16_t x_resolution, uint16_t y_resolution, uint16_t cpi);
+
+// value * scale in Q8; the remainder carries into the next call so slow motion is not lost
+static inline int16_t azoteq_iqs7211e_units_scale(int16_t value, uint16_t scale, int16_t *residue) {
+    if (scale == AZOTEQ_IQS7211E_UNITS_ONE) {
+        return value;
+    }
+
+    int32_t scaled = (int32_t)value * scale + *residue;
+    int16_t result = scaled >> 8;
+    *residue       = scaled - ((int32_t)result << 8);
+    return result;
+}
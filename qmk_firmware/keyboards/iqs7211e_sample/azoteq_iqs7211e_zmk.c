@@ -0,0 +1,146 @@
+/*
+Copyright 2024 sekigon (@sekigon-gonnoc)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ZMK input device glue around the portable IQS7211E core, built by the
+// Zephyr module in zmk/ at the top of the repository. The core keeps its
+// state in file statics, so it drives a single sensor; the first init sleeps
+// through reset and ATI and therefore runs on the work queue.
+
+#define DT_DRV_COMPAT azoteq_iqs7211e
+
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include "azoteq_iqs7211e.h"
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "azoteq,iqs7211e supports exactly one instance");
+
+struct azoteq_iqs7211e_zmk_config {
+    struct i2c_dt_spec  i2c;
+    struct gpio_dt_spec rdy;
+    uint16_t            poll_interval_ms;
+};
+
+struct azoteq_iqs7211e_zmk_data {
+    const struct device    *dev;
+    struct k_work_delayable work;
+    struct gpio_callback    rdy_callback;
+    uint8_t                 buttons;
+    bool                    initialized;
+};
+
+const struct i2c_dt_spec  *azoteq_iqs7211e_zmk_i2c = NULL;
+const struct gpio_dt_spec *azoteq_iqs7211e_zmk_rdy = NULL;
+
+typedef struct {
+    uint8_t  type;
+    uint16_t code;
+    int32_t  value;
+} azoteq_iqs7211e_zmk_event_t;
+
+static const uint16_t azoteq_iqs7211e_zmk_button_code[] = {INPUT_BTN_0, INPUT_BTN_1};
+
+// Map one frame onto input events; only the last event of a frame syncs
+static void azoteq_iqs7211e_zmk_report(const struct device *dev, azoteq_iqs7211e_motion_t motion) {
+    struct azoteq_iqs7211e_zmk_data *data = dev->data;
+    azoteq_iqs7211e_zmk_event_t      events[6];
+    uint8_t                          count = 0;
+
+    if (motion.x != 0) {
+        events[count++] = (azoteq_iqs7211e_zmk_event_t){INPUT_EV_REL, INPUT_REL_X, motion.x};
+    }
+    if (motion.y != 0) {
+        events[count++] = (azoteq_iqs7211e_zmk_event_t){INPUT_EV_REL, INPUT_REL_Y, motion.y};
+    }
+    if (motion.v != 0) {
+        events[count++] = (azoteq_iqs7211e_zmk_event_t){INPUT_EV_REL, INPUT_REL_WHEEL, motion.v};
+    }
+    if (motion.h != 0) {
+        events[count++] = (azoteq_iqs7211e_zmk_event_t){INPUT_EV_REL, INPUT_REL_HWHEEL, motion.h};
+    }
+    for (uint8_t i = 0; i < ARRAY_SIZE(azoteq_iqs7211e_zmk_button_code); i++) {
+        uint8_t mask = AZOTEQ_IQS7211E_BUTTON_1 << i;
+        if ((motion.buttons ^ data->buttons) & mask) {
+            events[count++] = (azoteq_iqs7211e_zmk_event_t){INPUT_EV_KEY, azoteq_iqs7211e_zmk_button_code[i], (motion.buttons & mask) != 0};
+        }
+    }
+    data->buttons = motion.buttons;
+
+    for (uint8_t i = 0; i < count; i++) {
+        input_report(dev, events[i].type, events[i].code, events[i].value, i == count - 1, K_FOREVER);
+    }
+}
+
+static void azoteq_iqs7211e_zmk_rdy_handler(const struct device *port, struct gpio_callback *callback, gpio_port_pins_t pins) {
+    struct azoteq_iqs7211e_zmk_data *data = CONTAINER_OF(callback, struct azoteq_iqs7211e_zmk_data, rdy_callback);
+
+    k_work_reschedule(&data->work, K_NO_WAIT);
+}
+
+// RDY wakes the work item for each frame; the poll interval keeps the
+// timer-driven parts of the core running while the sensor is silent
+static void azoteq_iqs7211e_zmk_work(struct k_work *work) {
+    struct k_work_delayable                 *dwork  = k_work_delayable_from_work(work);
+    struct azoteq_iqs7211e_zmk_data         *data   = CONTAINER_OF(dwork, struct azoteq_iqs7211e_zmk_data, work);
+    const struct azoteq_iqs7211e_zmk_config *config = data->dev->config;
+
+    if (data->initialized) {
+        azoteq_iqs7211e_zmk_report(data->dev, azoteq_iqs7211e_read_motion());
+    } else {
+        azoteq_iqs7211e_init();
+        data->initialized = true;
+
+        if (azoteq_iqs7211e_zmk_rdy != NULL) {
+            gpio_init_callback(&data->rdy_callback, azoteq_iqs7211e_zmk_rdy_handler, BIT(config->rdy.pin));
+            if (gpio_add_callback(config->rdy.port, &data->rdy_callback) == 0) {
+                gpio_pin_interrupt_configure_dt(&config->rdy, GPIO_INT_EDGE_TO_ACTIVE);
+            }
+        }
+    }
+
+    k_work_schedule(&data->work, K_MSEC(config->poll_interval_ms));
+}
+
+static int azoteq_iqs7211e_zmk_init(const struct device *dev) {
+    const struct azoteq_iqs7211e_zmk_config *config = dev->config;
+    struct azoteq_iqs7211e_zmk_data         *data   = dev->data;
+
+    if (!i2c_is_ready_dt(&config->i2c)) {
+        return -ENODEV;
+    }
+
+    azoteq_iqs7211e_zmk_i2c = &config->i2c;
+    azoteq_iqs7211e_zmk_rdy = config->rdy.port != NULL ? &config->rdy : NULL;
+
+    data->dev = dev;
+    k_work_init_delayable(&data->work, azoteq_iqs7211e_zmk_work);
+    k_work_schedule(&data->work, K_NO_WAIT);
+
+    return 0;
+}
+
+#define AZOTEQ_IQS7211E_ZMK_DEFINE(n)                                                       \
+    static struct azoteq_iqs7211e_zmk_data         azoteq_iqs7211e_zmk_data_##n;            \
+    static const struct azoteq_iqs7211e_zmk_config azoteq_iqs7211e_zmk_config_##n = {       \
+        .i2c              = I2C_DT_SPEC_INST_GET(n),                                        \
+        .rdy              = GPIO_DT_SPEC_INST_GET_OR(n, rdy_gpios, {0}),                    \
+        .poll_interval_ms = DT_INST_PROP(n, poll_interval_ms),                              \
+    };                                                                                      \
+    DEVICE_DT_INST_DEFINE(n, azoteq_iqs7211e_zmk_init, NULL, &azoteq_iqs7211e_zmk_data_##n, \
+                          &azoteq_iqs7211e_zmk_config_##n, POST_KERNEL,                     \
+                          CONFIG_INPUT_INIT_PRIORITY, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(AZOTEQ_IQS7211E_ZMK_DEFINE)
@@ -3,7 +3,11 @@
 #define I2C_DRIVER I2CD1
 #define I2C1_SDA_PIN GP18
 #define I2C1_SCL_PIN GP19
+#define I2C1_CLOCK_SPEED 400000
 
 #define MOUSE_EXTENDED_REPORT
 
-#define AZOTEQ_IQS7211E_RDY_PIN 21
\ No newline at end of file
+#define AZOTEQ_IQS7211E_RDY_PIN 21
+
+// Runtime tunables block (see azoteq_iqs7211e_tunables.h)
+#define EECONFIG_KB_DATA_SIZE 64
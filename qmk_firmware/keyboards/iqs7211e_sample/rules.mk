@@ -1,4 +1,23 @@
 POINTING_DEVICE_DRIVER = custom
 SRC += azoteq_iqs7211e.c
+SRC += azoteq_iqs7211e_qmk.c
+SRC += azoteq_iqs7211e_tunables.c
+SRC += azoteq_iqs7211e_tracker.c
+SRC += azoteq_iqs7211e_predictor.c
+SRC += azoteq_iqs7211e_filter.c
+SRC += azoteq_iqs7211e_rim.c
+SRC += azoteq_iqs7211e_pinch.c
+SRC += azoteq_iqs7211e_diag.c
+SRC += azoteq_iqs7211e_noise.c
+SRC += azoteq_iqs7211e_log.c
+SRC += azoteq_iqs7211e_split.c
+SRC += azoteq_iqs7211e_units.c
+SRC += azoteq_iqs7211e_power.c
 I2C_DRIVER_REQUIRED = yes
-    
\ No newline at end of file
+
+# Precision touchpad mode needs a digitizer HID interface that QMK does not
+# provide; see azoteq_iqs7211e_ptp.h for what the keyboard has to supply
+ifeq ($(strip $(AZOTEQ_IQS7211E_PTP_ENABLE)), yes)
+    SRC += azoteq_iqs7211e_ptp.c
+    OPT_DEFS += -DAZOTEQ_IQS7211E_PTP_ENABLE
+endif
@@ -0,0 +1,86 @@
+/*
+ * Run the portable IQS7211E core on the host against a simulated sensor and
+ * replay recorded traces through init and the full frame pipeline, reporting
+ * the per-frame cost of azoteq_iqs7211e_read_motion() on this host and the
+ * total motion it produced.
+ *
+ * The simulated sensor and the trace format are described in sensor_sim.h.
+ * Feature flags (-DAZOTEQ_IQS7211E_PREDICT_ENABLE, ...) are passed the same
+ * way as in config.h.
+ *
+ * Build:
+ *   K=../qmk_firmware/keyboards/iqs7211e_sample
+ *   cc -O2 -DAZOTEQ_IQS7211E_PLATFORM_HOST -I$K -o core_bench core_bench.c \
+ *      $K/azoteq_iqs7211e.c $K/azoteq_iqs7211e_tunables.c $K/azoteq_iqs7211e_tracker.c \
+ *      $K/azoteq_iqs7211e_predictor.c $K/azoteq_iqs7211e_filter.c $K/azoteq_iqs7211e_rim.c \
+ *      $K/azoteq_iqs7211e_pinch.c $K/azoteq_iqs7211e_ptp.c $K/azoteq_iqs7211e_diag.c \
+ *      $K/azoteq_iqs7211e_noise.c $K/azoteq_iqs7211e_log.c $K/azoteq_iqs7211e_units.c -lm
+ * Usage:
+ *   ./core_bench trace.txt [trace2.txt ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor_sim.h"
+
+#define BENCH_PASSES 200
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.txt [trace2.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    sensor_reset();
+    azoteq_iqs7211e_init();
+    if (sensor_reset_pending()) {
+        fprintf(stderr, "init did not acknowledge the reset\n");
+        return 1;
+    }
+
+    printf("%-24s %8s %10s %10s %10s %8s\n", "trace", "frames", "ns/frame", "|x|+|y|", "|v|+|h|", "clicks");
+
+    for (int i = 1; i < argc; i++) {
+        size_t   count;
+        frame_t *frames = load_trace(argv[i], &count);
+        if (frames == NULL || count < 2) {
+            free(frames);
+            continue;
+        }
+
+        uint64_t pointer = 0, scroll = 0;
+        uint32_t clicks  = 0;
+        uint8_t  buttons = 0;
+        double   elapsed = 0;
+
+        for (int pass = 0; pass < BENCH_PASSES; pass++) {
+            uint32_t base_time = azoteq_iqs7211e_host_time_us / 1000 + 1000;
+
+            for (size_t f = 0; f < count; f++) {
+                sensor_load_frame(&frames[f], &frames[f ? f - 1 : 0]);
+                azoteq_iqs7211e_host_time_us = (base_time + frames[f].time - frames[0].time) * 1000;
+
+                struct timespec          start, end;
+                azoteq_iqs7211e_motion_t motion;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                motion = azoteq_iqs7211e_read_motion();
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                elapsed += (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+                if (pass == 0) {
+                    pointer += abs(motion.x) + abs(motion.y);
+                    scroll += abs(motion.v) + abs(motion.h);
+                    clicks += (motion.buttons & ~buttons) != 0;
+                    buttons = motion.buttons;
+                }
+            }
+        }
+
+        printf("%-24s %8zu %10.1f %10llu %10llu %8u\n", argv[i], count, elapsed / ((double)count * BENCH_PASSES), (unsigned long long)pointer, (unsigned long long)scroll, clicks);
+        free(frames);
+    }
+
+    return 0;
+}
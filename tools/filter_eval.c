@@ -0,0 +1,148 @@
+/*
+ * Replay recorded IQS7211E traces through the adaptive jitter filter and
+ * report its per-frame cost on this host, the jitter left in the output and
+ * the lag it adds while the finger moves.
+ *
+ * Jitter is the RMS second difference of the position (frame-to-frame
+ * change in velocity), which is dominated by sensor noise. Lag is the RMS
+ * distance between filtered and raw position on frames where the finger
+ * moves faster than MOVING_SPEED counts per frame.
+ *
+ * Traces are recorded as described in sensor_sim.h.
+ *
+ * Build:
+ *   cc -O2 -I../qmk_firmware/keyboards/iqs7211e_sample -o filter_eval \
+ *      filter_eval.c ../qmk_firmware/keyboards/iqs7211e_sample/azoteq_iqs7211e_filter.c -lm
+ * Usage:
+ *   ./filter_eval trace.txt [trace2.txt ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "sensor_sim.h"
+#include "azoteq_iqs7211e_filter.h"
+
+#define MOVING_SPEED 3
+#define BENCH_PASSES 2000
+
+typedef struct {
+    uint32_t frames;
+    double   raw_jitter;
+    double   filtered_jitter;
+    uint32_t moving_frames;
+    double   lag;
+} result_t;
+
+static void evaluate_segment(const frame_t *frames, size_t first, size_t last, int8_t slot, result_t *result) {
+    azoteq_iqs7211e_filter_t filter;
+    uint16_t                 out_x[3] = {0}, out_y[3] = {0};
+
+    azoteq_iqs7211e_filter_reset(&filter, trace_x(&frames[first], slot), trace_y(&frames[first], slot));
+    out_x[2] = trace_x(&frames[first], slot);
+    out_y[2] = trace_y(&frames[first], slot);
+
+    for (size_t i = first + 1; i <= last; i++) {
+        uint16_t x = trace_x(&frames[i], slot), y = trace_y(&frames[i], slot);
+        azoteq_iqs7211e_filter_update(&filter, &x, &y, frames[i].time - frames[i - 1].time);
+
+        out_x[0] = out_x[1];
+        out_y[0] = out_y[1];
+        out_x[1] = out_x[2];
+        out_y[1] = out_y[2];
+        out_x[2] = x;
+        out_y[2] = y;
+
+        if (i >= first + 2) {
+            double raw_ax = trace_x(&frames[i], slot) - 2.0 * trace_x(&frames[i - 1], slot) + trace_x(&frames[i - 2], slot);
+            double raw_ay = trace_y(&frames[i], slot) - 2.0 * trace_y(&frames[i - 1], slot) + trace_y(&frames[i - 2], slot);
+            double out_ax = out_x[2] - 2.0 * out_x[1] + out_x[0];
+            double out_ay = out_y[2] - 2.0 * out_y[1] + out_y[0];
+            result->raw_jitter += raw_ax * raw_ax + raw_ay * raw_ay;
+            result->filtered_jitter += out_ax * out_ax + out_ay * out_ay;
+            result->frames++;
+        }
+
+        double speed = hypot(trace_x(&frames[i], slot) - trace_x(&frames[i - 1], slot), trace_y(&frames[i], slot) - trace_y(&frames[i - 1], slot));
+        if (speed > MOVING_SPEED) {
+            double lag_x = (double)x - trace_x(&frames[i], slot);
+            double lag_y = (double)y - trace_y(&frames[i], slot);
+            result->lag += lag_x * lag_x + lag_y * lag_y;
+            result->moving_frames++;
+        }
+    }
+}
+
+static double bench_ns_per_frame(const frame_t *frames, size_t count) {
+    azoteq_iqs7211e_filter_t filter;
+    struct timespec          start, end;
+    volatile uint16_t        sink = 0;
+
+    azoteq_iqs7211e_filter_reset(&filter, frames[0].x1, frames[0].y1);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        for (size_t i = 1; i < count; i++) {
+            uint16_t x = frames[i].x1, y = frames[i].y1;
+            azoteq_iqs7211e_filter_update(&filter, &x, &y, 15);
+            sink += x + y;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    return elapsed / ((double)BENCH_PASSES * (count - 1));
+}
+
+int main(int argc, char **argv) {
+    result_t result = {0};
+    double   cost   = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.txt [...]\n", argv[0]);
+        return 1;
+    }
+
+    for (int arg = 1; arg < argc; arg++) {
+        size_t   count;
+        frame_t *frames = load_trace(argv[arg], &count);
+        if (frames == NULL) {
+            return 1;
+        }
+
+        size_t i = 0;
+        while (i < count) {
+            int8_t slot = trace_single_slot(&frames[i]);
+            if (slot < 0) {
+                i++;
+                continue;
+            }
+            size_t first = i;
+            while (i + 1 < count && trace_single_slot(&frames[i + 1]) == slot) {
+                i++;
+            }
+            if (i > first) {
+                evaluate_segment(frames, first, i, slot, &result);
+            }
+            i++;
+        }
+
+        if (count > 1) {
+            cost = bench_ns_per_frame(frames, count);
+        }
+        free(frames);
+    }
+
+    if (result.frames == 0) {
+        printf("no single-finger motion found\n");
+        return 1;
+    }
+
+    printf("frames           %u\n", result.frames);
+    printf("cost             %.1f ns/frame on this host\n", cost);
+    printf("jitter raw       %.2f counts rms\n", sqrt(result.raw_jitter / result.frames));
+    printf("jitter filtered  %.2f counts rms\n", sqrt(result.filtered_jitter / result.frames));
+    printf("lag in motion    %.2f counts rms over %u frames\n", result.moving_frames ? sqrt(result.lag / result.moving_frames) : 0.0, result.moving_frames);
+    return 0;
+}
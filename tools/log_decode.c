@@ -0,0 +1,143 @@
+/*
+ * Decode the IQS7211E binary event log.
+ *
+ * Reads console output with "L,<dropped>,<record>,..." lines, where each
+ * record is the 8 stored bytes in hex, or raw HID responses to
+ * id_custom_get_value with AZOTEQ_IQS7211E_LOG_VALUE_ID dumped as whitespace
+ * separated hex bytes, one packet per line. Event names and argument labels come from
+ * azoteq_iqs7211e_log.h, so the decoder always matches the firmware it was
+ * built against.
+ *
+ * Build:
+ *   cc -O2 -I../qmk_firmware/keyboards/iqs7211e_sample -o log_decode log_decode.c
+ * Usage:
+ *   ./log_decode console.txt
+ *   hid_listen | ./log_decode -
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "azoteq_iqs7211e_log.h"
+
+typedef struct {
+    const char *name;
+    uint8_t     level;
+    const char *a;
+    const char *b;
+} event_desc_t;
+
+static const event_desc_t event_desc[AZOTEQ_IQS7211E_EVENT_COUNT] = {
+#define EVENT_DESC(name, level, a, b) [AZOTEQ_IQS7211E_EVENT_##name] = {#name, level, a, b},
+    AZOTEQ_IQS7211E_LOG_EVENTS(EVENT_DESC)
+#undef EVENT_DESC
+};
+
+static const char *const level_name[] = {"NONE", "ERROR", "WARN", "INFO", "DEBUG"};
+
+static void print_dropped(unsigned dropped) {
+    if (dropped > 0) {
+        printf("           -- %u%s records dropped --\n", dropped, dropped == 255 ? "+" : "");
+    }
+}
+
+static void print_record(const uint8_t bytes[8]) {
+    uint32_t time  = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    uint8_t  event = bytes[4];
+    uint8_t  a     = bytes[5];
+    uint16_t b     = bytes[6] | (bytes[7] << 8);
+
+    if (event >= AZOTEQ_IQS7211E_EVENT_COUNT) {
+        printf("%10u  ?     event %u a=%u b=%u\n", time, event, a, b);
+        return;
+    }
+
+    const event_desc_t *desc = &event_desc[event];
+    printf("%10u  %-5s %s", time, level_name[desc->level], desc->name);
+    if (desc->a != NULL) {
+        // Status codes are signed in the firmware
+        printf(" %s=%d", desc->a, strcmp(desc->a, "status") == 0 ? (int8_t)a : a);
+    }
+    if (desc->b != NULL) {
+        printf(" %s=%d", desc->b, strcmp(desc->b, "status") == 0 ? (int16_t)b : b);
+    }
+    printf("\n");
+}
+
+static int parse_hex_byte(const char *text, uint8_t *byte) {
+    unsigned value;
+    if (sscanf(text, "%2x", &value) != 1) {
+        return 0;
+    }
+    *byte = value;
+    return 1;
+}
+
+static void decode_console_line(const char *line) {
+    unsigned dropped;
+    if (sscanf(line, "L,%u", &dropped) != 1) {
+        return;
+    }
+    print_dropped(dropped);
+
+    const char *field = strchr(line + 2, ',');
+    while (field != NULL) {
+        uint8_t bytes[8];
+        int     i;
+        field++;
+        for (i = 0; i < 8 && parse_hex_byte(field + i * 2, &bytes[i]); i++) {
+        }
+        if (i == 8) {
+            print_record(bytes);
+        }
+        field = strchr(field, ',');
+    }
+}
+
+static void decode_packet_line(const char *line) {
+    uint8_t packet[64];
+    int     length = 0, offset;
+    unsigned value;
+
+    while (length < (int)sizeof(packet) && sscanf(line, "%x%n", &value, &offset) == 1) {
+        packet[length++] = value;
+        line += offset;
+    }
+    // [0] id_custom_get_value, [1] channel, [2] value id, [3] records, [4] dropped
+    if (length < 5 || packet[0] != 0x08 || packet[2] != AZOTEQ_IQS7211E_LOG_VALUE_ID) {
+        return;
+    }
+
+    print_dropped(packet[4]);
+    for (int i = 0; i < packet[3] && 5 + (i + 1) * 8 <= length; i++) {
+        print_record(&packet[5 + i * 8]);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s log.txt|-\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "r");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        const char *start = strstr(line, "L,");
+        if (start != NULL) {
+            decode_console_line(start);
+        } else {
+            decode_packet_line(line);
+        }
+    }
+
+    if (file != stdin) {
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Replay recorded IQS7211E traces through the full frame pipeline with the
+ * motion predictor enabled and compare the cursor position it produces
+ * against the finger position one horizon later, with the plain
+ * (unpredicted) position as the baseline. Frames go through
+ * azoteq_iqs7211e_read_motion() against the simulated sensor, so frames the
+ * driver skips or decodes at a stop count the same as on the keyboard.
+ *
+ * Traces are recorded as described in sensor_sim.h. The pointer scale is
+ * held at one output count per sensor count, and no mounting transform may
+ * be defined, so the cursor is in sensor counts.
+ *
+ * Build:
+ *   K=../qmk_firmware/keyboards/iqs7211e_sample
+ *   cc -O2 -DAZOTEQ_IQS7211E_PLATFORM_HOST -DAZOTEQ_IQS7211E_PREDICT_ENABLE -I$K \
+ *      -o predictor_eval predictor_eval.c \
+ *      $K/azoteq_iqs7211e.c $K/azoteq_iqs7211e_tunables.c $K/azoteq_iqs7211e_tracker.c \
+ *      $K/azoteq_iqs7211e_predictor.c $K/azoteq_iqs7211e_filter.c $K/azoteq_iqs7211e_rim.c \
+ *      $K/azoteq_iqs7211e_pinch.c $K/azoteq_iqs7211e_ptp.c $K/azoteq_iqs7211e_diag.c \
+ *      $K/azoteq_iqs7211e_noise.c $K/azoteq_iqs7211e_log.c $K/azoteq_iqs7211e_units.c \
+ *      $K/azoteq_iqs7211e_power.c -lm
+ * Usage:
+ *   ./predictor_eval trace.txt [trace2.txt ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sensor_sim.h"
+#include "azoteq_iqs7211e_predictor.h"
+#include "azoteq_iqs7211e_units.h"
+#include "azoteq_iqs7211e_transform.h"
+
+#ifndef AZOTEQ_IQS7211E_PREDICT_ENABLE
+#    error "predictor_eval needs -DAZOTEQ_IQS7211E_PREDICT_ENABLE"
+#endif
+#if AZOTEQ_IQS7211E_ROTATION != 0 || defined(AZOTEQ_IQS7211E_SWAP_XY) || defined(AZOTEQ_IQS7211E_INVERT_X) || defined(AZOTEQ_IQS7211E_INVERT_Y)
+#    error "predictor_eval compares the cursor with sensor coordinates, build it without a mounting transform"
+#endif
+
+// Untouched time between traces, so no gesture carries over
+#define TRACE_GAP_MS 2000
+
+typedef struct {
+    uint32_t frames;
+    double   lag_error;  // sum of squared errors, no prediction
+    double   pred_error; // sum of squared errors, predicted
+    uint32_t stops;
+    double   stop_residual;
+    double   stop_residual_max;
+} result_t;
+
+// Finger position at time t, interpolated within frames [first, last]
+static int position_at(const frame_t *frames, size_t first, size_t last, int8_t slot, uint32_t t, double *x, double *y) {
+    for (size_t i = first; i < last; i++) {
+        if (frames[i].time <= t && frames[i + 1].time >= t) {
+            double span = frames[i + 1].time - frames[i].time;
+            double k    = span > 0 ? (t - frames[i].time) / span : 0;
+            *x          = trace_x(&frames[i], slot) + k * (trace_x(&frames[i + 1], slot) - trace_x(&frames[i], slot));
+            *y          = trace_y(&frames[i], slot) + k * (trace_y(&frames[i + 1], slot) - trace_y(&frames[i], slot));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Feed every frame of a trace through the driver and keep the motion it reports
+static void replay(const frame_t *frames, size_t count, int32_t *motion_x, int32_t *motion_y) {
+    static const frame_t lifted = {0, 0, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+    uint32_t             base   = azoteq_iqs7211e_host_time_us / 1000 + TRACE_GAP_MS;
+
+    sensor_load_frame(&lifted, &lifted);
+    azoteq_iqs7211e_read_motion();
+    azoteq_iqs7211e_host_time_us = base * 1000;
+    azoteq_iqs7211e_read_motion();
+
+    for (size_t f = 0; f < count; f++) {
+        sensor_load_frame(&frames[f], f ? &frames[f - 1] : &lifted);
+        azoteq_iqs7211e_host_time_us = (base + frames[f].time - frames[0].time) * 1000;
+
+        azoteq_iqs7211e_motion_t motion = azoteq_iqs7211e_read_motion();
+        motion_x[f]                     = motion.x;
+        motion_y[f]                     = motion.y;
+    }
+}
+
+static void evaluate_segment(const frame_t *frames, const int32_t *motion_x, const int32_t *motion_y, size_t first, size_t last, int8_t slot, result_t *result) {
+    // The cursor starts on the finger, then moves by what the driver reported
+    double cursor_x = trace_x(&frames[first], slot);
+    double cursor_y = trace_y(&frames[first], slot);
+
+    for (size_t i = first + 1; i <= last; i++) {
+        cursor_x += motion_x[i];
+        cursor_y += motion_y[i];
+
+        double truth_x, truth_y;
+        if (!position_at(frames, first, last, slot, frames[i].time + AZOTEQ_IQS7211E_PREDICT_HORIZON_MS, &truth_x, &truth_y)) {
+            continue;
+        }
+
+        double lag_x  = trace_x(&frames[i], slot) - truth_x;
+        double lag_y  = trace_y(&frames[i], slot) - truth_y;
+        double pred_x = cursor_x - truth_x;
+        double pred_y = cursor_y - truth_y;
+
+        result->lag_error += lag_x * lag_x + lag_y * lag_y;
+        result->pred_error += pred_x * pred_x + pred_y * pred_y;
+        result->frames++;
+    }
+
+    // Distance between the reported cursor and the finger once it lifts
+    double residual = hypot(cursor_x - trace_x(&frames[last], slot), cursor_y - trace_y(&frames[last], slot));
+    result->stop_residual += residual;
+    if (residual > result->stop_residual_max) {
+        result->stop_residual_max = residual;
+    }
+    result->stops++;
+}
+
+int main(int argc, char **argv) {
+    result_t result = {0};
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.txt [...]\n", argv[0]);
+        return 1;
+    }
+
+    sensor_reset();
+    azoteq_iqs7211e_init();
+    if (sensor_reset_pending()) {
+        fprintf(stderr, "init did not acknowledge the reset\n");
+        return 1;
+    }
+    azoteq_iqs7211e_units.pointer_scale = AZOTEQ_IQS7211E_UNITS_ONE;
+
+    for (int arg = 1; arg < argc; arg++) {
+        size_t   count;
+        frame_t *frames = load_trace(argv[arg], &count);
+        if (frames == NULL) {
+            return 1;
+        }
+
+        int32_t *motion_x = malloc(count * sizeof(int32_t));
+        int32_t *motion_y = malloc(count * sizeof(int32_t));
+        replay(frames, count, motion_x, motion_y);
+
+        // Single-finger segments are what the predictor runs on
+        size_t i = 0;
+        while (i < count) {
+            int8_t slot = trace_single_slot(&frames[i]);
+            if (slot < 0) {
+                i++;
+                continue;
+            }
+            size_t first = i;
+            while (i + 1 < count && trace_single_slot(&frames[i + 1]) == slot) {
+                i++;
+            }
+            if (i > first) {
+                evaluate_segment(frames, motion_x, motion_y, first, i, slot, &result);
+            }
+            i++;
+        }
+        free(motion_x);
+        free(motion_y);
+        free(frames);
+    }
+
+    if (result.frames == 0) {
+        printf("no single-finger motion found\n");
+        return 1;
+    }
+
+    double lag_rms  = sqrt(result.lag_error / result.frames);
+    double pred_rms = sqrt(result.pred_error / result.frames);
+
+    printf("horizon          %d ms\n", AZOTEQ_IQS7211E_PREDICT_HORIZON_MS);
+    printf("frames           %u\n", result.frames);
+    printf("lag error rms    %.2f counts\n", lag_rms);
+    printf("pred error rms   %.2f counts\n", pred_rms);
+    printf("lag removed      %.1f %%\n", lag_rms > 0 ? 100.0 * (1.0 - pred_rms / lag_rms) : 0.0);
+    printf("stop residual    %.2f mean, %.2f max counts over %u touches\n", result.stop_residual / result.stops, result.stop_residual_max, result.stops);
+    return 0;
+}
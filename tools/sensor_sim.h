@@ -0,0 +1,183 @@
+/*
+ * Trace parser and simulated IQS7211E shared by the host tools.
+ *
+ * Traces are recorded by building the firmware with
+ * AZOTEQ_IQS7211E_TRACE_ENABLE and saving the console output. Each frame is
+ * one line
+ *   T,<time ms>,<fingers>,<x1>,<y1>,<x2>,<y2>
+ * where x1,y1 and x2,y2 are the sensor's two finger slots as reported, 65535
+ * for an empty slot. A finger keeps its slot while it is down, so the second
+ * finger stays in slot 2 when the first one lifts. Traces that packed the
+ * fingers into the first slots and left zeros in the others are read the
+ * same way. Any other line is left to the tool (tune_search reads its labels
+ * from the same file) or ignored.
+ *
+ * With AZOTEQ_IQS7211E_PLATFORM_HOST the header also provides the simulated
+ * sensor behind the host platform hooks: a flat register file that answers
+ * the product number, flags a reset until it is acknowledged and finishes
+ * ATI as soon as it is requested. sensor_load_frame() writes a trace frame
+ * into the base data registers (0x0A - 0x17) before the core reads it.
+ *
+ * Every tool is a single translation unit, so the hooks and the host clock
+ * are defined here rather than declared.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t time;
+    uint8_t  fingers;
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+} frame_t;
+
+// Parse one T line, false if the line holds no frame
+static inline bool trace_parse_frame(const char *line, frame_t *frame) {
+    const char   *start = strstr(line, "T,");
+    unsigned long time;
+    unsigned      fingers, x1, y1, x2, y2;
+
+    if (start == NULL || sscanf(start, "T,%lu,%u,%u,%u,%u,%u", &time, &fingers, &x1, &y1, &x2, &y2) != 6) {
+        return false;
+    }
+    // More slots in use than fingers down: a packed trace, the fingers are in the first slots
+    unsigned used = (x1 != 0xFFFF) + (x2 != 0xFFFF);
+    if (used > fingers) {
+        if (fingers < 2) {
+            x2 = y2 = 0xFFFF;
+        }
+        if (fingers < 1) {
+            x1 = y1 = 0xFFFF;
+        }
+    }
+    *frame = (frame_t){time, fingers, x1, y1, x2, y2};
+    return true;
+}
+
+// Slot of the only finger down, -1 with none or two
+static inline int8_t trace_single_slot(const frame_t *frame) {
+    if (frame->fingers != 1) {
+        return -1;
+    }
+    return frame->x1 != 0xFFFF ? 0 : 1;
+}
+
+static inline uint16_t trace_x(const frame_t *frame, int8_t slot) {
+    return slot ? frame->x2 : frame->x1;
+}
+
+static inline uint16_t trace_y(const frame_t *frame, int8_t slot) {
+    return slot ? frame->y2 : frame->y1;
+}
+
+// Append a frame to a growing array
+static inline void trace_append(frame_t **frames, size_t *count, size_t *capacity, const frame_t *frame) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 1024;
+        *frames   = realloc(*frames, *capacity * sizeof(frame_t));
+    }
+    (*frames)[(*count)++] = *frame;
+}
+
+// All frames of a trace file, NULL if it cannot be opened
+static inline frame_t *load_trace(const char *path, size_t *count) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t   capacity = 1024;
+    frame_t *frames   = malloc(capacity * sizeof(frame_t));
+    char     line[128];
+    frame_t  frame;
+
+    *count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (trace_parse_frame(line, &frame)) {
+            trace_append(&frames, count, &capacity, &frame);
+        }
+    }
+
+    fclose(file);
+    return frames;
+}
+
+#ifdef AZOTEQ_IQS7211E_PLATFORM_HOST
+#    include "azoteq_iqs7211e.h"
+
+uint32_t azoteq_iqs7211e_host_time_us = 0;
+
+// Two bytes per register address, little endian like the sensor
+static uint8_t sensor_registers[256 * 2];
+
+static inline void sensor_set_word(uint8_t reg, uint16_t value) {
+    sensor_registers[reg * 2]     = value & 0xFF;
+    sensor_registers[reg * 2 + 1] = value >> 8;
+}
+
+static inline void sensor_reset(void) {
+    memset(sensor_registers, 0, sizeof(sensor_registers));
+    sensor_set_word(IQS7211E_MM_PROD_NUM, AZOTEQ_IQS7211E_PRODUCT_NUM);
+    sensor_registers[IQS7211E_MM_INFO_FLAGS * 2] = 1 << IQS7211E_SHOW_RESET_BIT;
+}
+
+// True until init has acknowledged the power-on reset
+static inline bool sensor_reset_pending(void) {
+    return sensor_registers[IQS7211E_MM_INFO_FLAGS * 2] & (1 << IQS7211E_SHOW_RESET_BIT);
+}
+
+i2c_status_t azoteq_iqs7211e_host_bus_read(uint8_t reg, uint8_t *data, uint16_t length) {
+    if (reg * 2 + length > sizeof(sensor_registers)) {
+        return I2C_STATUS_ERROR;
+    }
+    memcpy(data, &sensor_registers[reg * 2], length);
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t azoteq_iqs7211e_host_bus_write(uint8_t reg, const uint8_t *data, uint16_t length) {
+    if (reg == IQS7211E_MM_END_SESSION) {
+        return I2C_STATUS_SUCCESS;
+    }
+    if (reg * 2 + length > sizeof(sensor_registers)) {
+        return I2C_STATUS_ERROR;
+    }
+    memcpy(&sensor_registers[reg * 2], data, length);
+
+    if (reg == IQS7211E_MM_SYS_CONTROL) {
+        // ATI finishes instantly, the reset flag clears on acknowledge
+        if (data[0] & (1 << IQS7211E_ACK_RESET_BIT)) {
+            sensor_registers[IQS7211E_MM_INFO_FLAGS * 2] &= ~(1 << IQS7211E_SHOW_RESET_BIT);
+        }
+        sensor_registers[IQS7211E_MM_SYS_CONTROL * 2] &= ~((1 << IQS7211E_TP_RE_ATI_BIT) | (1 << IQS7211E_ALP_RE_ATI_BIT) | (1 << IQS7211E_ACK_RESET_BIT));
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+// Slots are written as the trace holds them, strength and area only for a finger that is down
+static inline void sensor_load_slot(uint8_t reg, uint16_t x, uint16_t y) {
+    sensor_set_word(reg, x);
+    sensor_set_word(reg + 1, y);
+    sensor_set_word(reg + 2, x != 0xFFFF ? 200 : 0);
+    sensor_set_word(reg + 3, x != 0xFFFF ? 8 : 0);
+}
+
+static inline void sensor_load_frame(const frame_t *frame, const frame_t *previous) {
+    bool moved = frame->fingers != previous->fingers || frame->x1 != previous->x1 || frame->y1 != previous->y1 || frame->x2 != previous->x2 || frame->y2 != previous->y2;
+    bool held  = frame->x1 != 0xFFFF && previous->x1 != 0xFFFF;
+
+    sensor_set_word(IQS7211E_MM_RELATIVE_X, held ? (uint16_t)(frame->x1 - previous->x1) : 0);
+    sensor_set_word(IQS7211E_MM_RELATIVE_Y, held ? (uint16_t)(frame->y1 - previous->y1) : 0);
+    sensor_set_word(IQS7211E_MM_INFO_FLAGS, (uint16_t)(frame->fingers | (moved ? 1 << IQS7211E_TP_MOVEMENT_BIT : 0)) << 8);
+    sensor_load_slot(IQS7211E_MM_FINGER_1_X, frame->x1, frame->y1);
+    sensor_load_slot(IQS7211E_MM_FINGER_2_X, frame->x2, frame->y2);
+}
+#endif
@@ -0,0 +1,539 @@
+/*
+ * Search the IQS7211E driver thresholds against a labelled trace corpus.
+ *
+ * Every candidate parameter set replays all traces through the portable core
+ * (init, then azoteq_iqs7211e_read_motion() per frame) against the same
+ * simulated sensor as core_bench (sensor_sim.h), and is scored on the labelled events. The
+ * grid is searched in parallel: the driver is initialised once, then one
+ * forked child per candidate starts from that snapshot, up to one child per
+ * host core. The best set is written as an IQS7211_init.h style block
+ * (<prefix>.h) and as the persisted tunables block (<prefix>.bin).
+ *
+ * Searched, through the runtime thresholds in azoteq_iqs7211e_units and
+ * azoteq_iqs7211e_filter_params:
+ *   tap distance   AZOTEQ_IQS7211E_TAP_DISTANCE_UM, also the sensor TAP_DISTANCE register
+ *   scroll step    AZOTEQ_IQS7211E_SCROLL_STEP_UM
+ *   scroll lock    AZOTEQ_IQS7211E_SCROLL_LOCK_UM, with AZOTEQ_IQS7211E_PINCH_ENABLE only
+ *   min cutoff     AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF, with AZOTEQ_IQS7211E_FILTER_ENABLE only
+ *   beta           AZOTEQ_IQS7211E_FILTER_BETA, with AZOTEQ_IQS7211E_FILTER_ENABLE only
+ * Traces hold the sensor's filtered coordinates, so sensor filter settings
+ * cannot be evaluated by replaying them and keep their init values; the
+ * driver-side One-Euro filter runs on top of them and is searched. The driver
+ * has no acceleration curve: pointer output is the contact delta times the
+ * fixed CPI scale, so there is no pointer speed setting to search.
+ *
+ * Traces are recorded with AZOTEQ_IQS7211E_TRACE_ENABLE as for core_bench.
+ * Labels are added to the same file, one line per intended gesture, with the
+ * times of the T lines; start is the touch, end the lift:
+ *   E,<start>,<end>,tap             one left click
+ *   E,<start>,<end>,right           one right click (two finger tap)
+ *   E,<start>,<end>,drag            pointer motion with the left button held
+ *   E,<start>,<end>,move            pointer motion, no click
+ *   E,<start>,<end>,scroll[,units]  scrolling, optionally the expected wheel units
+ *   E,<start>,<end>,zoom            pinch or rotate, no scrolling and no click
+ * Each missed event and each click outside a tap, right or drag event costs
+ * one; a scroll amount adds its relative error, up to one, and so does the
+ * pointer travel of a move or drag event against the unfiltered trace, which
+ * is what filter lag loses.
+ *
+ * Build:
+ *   K=../qmk_firmware/keyboards/iqs7211e_sample
+ *   cc -O2 -DAZOTEQ_IQS7211E_PLATFORM_HOST -DAZOTEQ_IQS7211E_PINCH_ENABLE \
+ *      -DAZOTEQ_IQS7211E_ZOOM_IN_KEYCODE=1 -DAZOTEQ_IQS7211E_ZOOM_OUT_KEYCODE=2 \
+ *      -I$K -o tune_search tune_search.c \
+ *      $K/azoteq_iqs7211e.c $K/azoteq_iqs7211e_tunables.c $K/azoteq_iqs7211e_tracker.c \
+ *      $K/azoteq_iqs7211e_predictor.c $K/azoteq_iqs7211e_filter.c $K/azoteq_iqs7211e_rim.c \
+ *      $K/azoteq_iqs7211e_pinch.c $K/azoteq_iqs7211e_ptp.c $K/azoteq_iqs7211e_diag.c \
+ *      $K/azoteq_iqs7211e_noise.c $K/azoteq_iqs7211e_log.c $K/azoteq_iqs7211e_units.c -lm
+ * Zoom keycodes keep pinch steps off the scroll wheel, so a pinch taken for
+ * a scroll shows up in the score. Add -DAZOTEQ_IQS7211E_FILTER_ENABLE to
+ * search the filter. Other feature flags as in config.h.
+ * Usage:
+ *   ./tune_search [-j jobs] [-o prefix] trace.txt [trace2.txt ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "sensor_sim.h"
+#include "azoteq_iqs7211e_units.h"
+#include "azoteq_iqs7211e_filter.h"
+#include "azoteq_iqs7211e_pinch.h"
+#include "IQS7211_init.h"
+
+// Clicks are sent on the lift frame, a little after the labelled end
+#define EVENT_SLACK_MS 100
+// Untouched time between traces, longer than any double tap window
+#define TRACE_GAP_MS 2000
+#define SHOW_BEST 10
+
+#define PAD_SIZE_UM ((uint32_t)AZOTEQ_IQS7211E_PAD_SIZE_MM * 1000)
+#define RESOLUTION ((((X_RESOLUTION_1 << 8) | X_RESOLUTION_0) + ((Y_RESOLUTION_1 << 8) | Y_RESOLUTION_0)) / 2)
+
+typedef enum {
+    EVENT_TAP,
+    EVENT_RIGHT,
+    EVENT_DRAG,
+    EVENT_MOVE,
+    EVENT_SCROLL,
+    EVENT_ZOOM,
+    EVENT_KIND_COUNT,
+} event_kind_t;
+
+static const char *const event_names[EVENT_KIND_COUNT] = {"tap", "right", "drag", "move", "scroll", "zoom"};
+
+typedef struct {
+    uint32_t     start;
+    uint32_t     end;
+    event_kind_t kind;
+    uint32_t     amount; // expected wheel units, 0 if not given
+} event_t;
+
+typedef struct {
+    frame_t *frames;
+    size_t   frame_count;
+    event_t *events;
+    size_t   event_count;
+    int32_t *frame_event; // event covering each frame, -1 for none
+} trace_t;
+
+typedef struct {
+    uint16_t tap_distance_um;
+    uint16_t scroll_step_um;
+    uint16_t scroll_lock_um;
+    uint16_t min_cutoff_mhz;
+    uint16_t beta;
+} candidate_t;
+
+typedef struct {
+    double   cost;
+    uint32_t missed;
+    uint32_t spurious;
+    uint8_t  done;
+} result_t;
+
+typedef struct {
+    uint16_t first;
+    uint16_t last;
+    uint16_t step;
+} range_t;
+
+static const range_t tap_distance_range = {500, 3000, 100};
+static const range_t scroll_step_range  = {10, 150, 5};
+#ifdef AZOTEQ_IQS7211E_PINCH_ENABLE
+static const range_t scroll_lock_range = {240, 2400, 120};
+#else
+static const range_t scroll_lock_range = {AZOTEQ_IQS7211E_SCROLL_LOCK_UM, AZOTEQ_IQS7211E_SCROLL_LOCK_UM, 1};
+#endif
+#ifdef AZOTEQ_IQS7211E_FILTER_ENABLE
+static const range_t min_cutoff_range = {500, 2500, 500};
+static const range_t beta_range       = {0, 80, 20};
+#else
+static const range_t min_cutoff_range = {AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF, AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF, 1};
+static const range_t beta_range       = {AZOTEQ_IQS7211E_FILTER_BETA, AZOTEQ_IQS7211E_FILTER_BETA, 1};
+#endif
+
+static bool load_labelled_trace(const char *path, trace_t *trace) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    size_t frame_capacity = 1024, event_capacity = 64;
+    char   line[128];
+
+    *trace        = (trace_t){0};
+    trace->frames = malloc(frame_capacity * sizeof(frame_t));
+    trace->events = malloc(event_capacity * sizeof(event_t));
+
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long time, end;
+        unsigned      amount = 0;
+        char          kind[16];
+        const char   *start;
+        frame_t       frame;
+
+        if (trace_parse_frame(line, &frame)) {
+            trace_append(&trace->frames, &trace->frame_count, &frame_capacity, &frame);
+        } else if ((start = strstr(line, "E,")) != NULL && sscanf(start, "E,%lu,%lu,%15[a-z],%u", &time, &end, kind, &amount) >= 3) {
+            event_kind_t k = 0;
+            while (k < EVENT_KIND_COUNT && strcmp(kind, event_names[k]) != 0) {
+                k++;
+            }
+            if (k == EVENT_KIND_COUNT) {
+                fprintf(stderr, "%s: unknown event '%s'\n", path, kind);
+                continue;
+            }
+            if (trace->event_count == event_capacity) {
+                event_capacity *= 2;
+                trace->events = realloc(trace->events, event_capacity * sizeof(event_t));
+            }
+            trace->events[trace->event_count++] = (event_t){time, end, k, amount};
+        }
+    }
+    fclose(file);
+
+    if (trace->frame_count < 2) {
+        return false;
+    }
+
+    // First matching label wins if labels overlap
+    trace->frame_event = malloc(trace->frame_count * sizeof(int32_t));
+    for (size_t f = 0; f < trace->frame_count; f++) {
+        trace->frame_event[f] = -1;
+        for (size_t e = 0; e < trace->event_count; e++) {
+            if (trace->frames[f].time >= trace->events[e].start && trace->frames[f].time <= trace->events[e].end + EVENT_SLACK_MS) {
+                trace->frame_event[f] = e;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static uint16_t range_count(const range_t *range) {
+    return (range->last - range->first) / range->step + 1;
+}
+
+static candidate_t candidate_at(size_t index) {
+    candidate_t candidate;
+
+    candidate.tap_distance_um = tap_distance_range.first + (index % range_count(&tap_distance_range)) * tap_distance_range.step;
+    index /= range_count(&tap_distance_range);
+    candidate.scroll_step_um = scroll_step_range.first + (index % range_count(&scroll_step_range)) * scroll_step_range.step;
+    index /= range_count(&scroll_step_range);
+    candidate.scroll_lock_um = scroll_lock_range.first + (index % range_count(&scroll_lock_range)) * scroll_lock_range.step;
+    index /= range_count(&scroll_lock_range);
+    candidate.min_cutoff_mhz = min_cutoff_range.first + (index % range_count(&min_cutoff_range)) * min_cutoff_range.step;
+    index /= range_count(&min_cutoff_range);
+    candidate.beta = beta_range.first + index * beta_range.step;
+    return candidate;
+}
+
+// Same rounding as azoteq_iqs7211e_units.c
+static uint16_t um_to_counts(uint32_t um) {
+    uint32_t counts = (um * RESOLUTION + PAD_SIZE_UM / 2) / PAD_SIZE_UM;
+    return counts > 0 ? counts : 1;
+}
+
+static void apply_candidate(const candidate_t *candidate) {
+    azoteq_iqs7211e_units.tap_distance = um_to_counts(candidate->tap_distance_um);
+    azoteq_iqs7211e_units.scroll_scale = (PAD_SIZE_UM * AZOTEQ_IQS7211E_UNITS_ONE + (uint32_t)RESOLUTION * candidate->scroll_step_um / 2) / ((uint32_t)RESOLUTION * candidate->scroll_step_um);
+    azoteq_iqs7211e_units.scroll_lock  = um_to_counts(candidate->scroll_lock_um);
+
+    azoteq_iqs7211e_filter_params.min_cutoff = candidate->min_cutoff_mhz;
+    azoteq_iqs7211e_filter_params.beta       = candidate->beta;
+}
+
+// Output accumulated over the frames of one labelled event
+typedef struct {
+    uint32_t left_clicks;
+    uint32_t right_clicks;
+    uint32_t pointer;
+    uint32_t scroll;
+    uint32_t dragged; // pointer motion with the left button held
+    int32_t  net_x;   // signed pointer output
+    int32_t  net_y;
+    int32_t  raw_x;   // signed single finger travel in the trace, sensor counts
+    int32_t  raw_y;
+} event_output_t;
+
+// Relative shortfall or overshoot of the net pointer travel, up to one. The
+// axis transform only swaps and negates, so the L1 length is comparable.
+static double travel_error(const event_output_t *output) {
+    double expected = (double)(abs(output->raw_x) + abs(output->raw_y)) * azoteq_iqs7211e_units.pointer_scale / AZOTEQ_IQS7211E_UNITS_ONE;
+    double actual   = abs(output->net_x) + abs(output->net_y);
+
+    if (expected < 1) {
+        return 0;
+    }
+    return fmin(1.0, fabs(actual - expected) / expected);
+}
+
+static void evaluate(const trace_t *traces, size_t trace_count, const candidate_t *candidate, result_t *result) {
+    static const frame_t lifted = {0, 0, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+
+    apply_candidate(candidate);
+    *result = (result_t){0};
+
+    for (size_t t = 0; t < trace_count; t++) {
+        const trace_t  *trace   = &traces[t];
+        event_output_t *outputs = calloc(trace->event_count ? trace->event_count : 1, sizeof(event_output_t));
+        uint32_t        base    = azoteq_iqs7211e_host_time_us / 1000 + TRACE_GAP_MS;
+        uint8_t         buttons = 0;
+
+        // Lift any finger left from the previous trace and let every gesture timer expire
+        sensor_load_frame(&lifted, &lifted);
+        azoteq_iqs7211e_read_motion();
+        azoteq_iqs7211e_host_time_us = base * 1000;
+        azoteq_iqs7211e_read_motion();
+
+        for (size_t f = 0; f < trace->frame_count; f++) {
+            sensor_load_frame(&trace->frames[f], f ? &trace->frames[f - 1] : &lifted);
+            azoteq_iqs7211e_host_time_us = (base + trace->frames[f].time - trace->frames[0].time) * 1000;
+
+            azoteq_iqs7211e_motion_t motion  = azoteq_iqs7211e_read_motion();
+            uint8_t                  pressed = motion.buttons & ~buttons;
+            int32_t                  e       = trace->frame_event[f];
+            buttons                          = motion.buttons;
+
+            if (e < 0) {
+                result->spurious += ((pressed & AZOTEQ_IQS7211E_BUTTON_1) != 0) + ((pressed & AZOTEQ_IQS7211E_BUTTON_2) != 0);
+                continue;
+            }
+
+            event_output_t *output = &outputs[e];
+            output->left_clicks += (pressed & AZOTEQ_IQS7211E_BUTTON_1) != 0;
+            output->right_clicks += (pressed & AZOTEQ_IQS7211E_BUTTON_2) != 0;
+            output->pointer += abs(motion.x) + abs(motion.y);
+            output->scroll += abs(motion.v) + abs(motion.h);
+            if (motion.buttons & AZOTEQ_IQS7211E_BUTTON_1) {
+                output->dragged += abs(motion.x) + abs(motion.y);
+            }
+            output->net_x += motion.x;
+            output->net_y += motion.y;
+            int8_t slot = trace_single_slot(&trace->frames[f]);
+            if (f > 0 && slot >= 0 && trace_single_slot(&trace->frames[f - 1]) == slot) {
+                output->raw_x += trace_x(&trace->frames[f], slot) - trace_x(&trace->frames[f - 1], slot);
+                output->raw_y += trace_y(&trace->frames[f], slot) - trace_y(&trace->frames[f - 1], slot);
+            }
+        }
+
+        for (size_t e = 0; e < trace->event_count; e++) {
+            const event_t        *event  = &trace->events[e];
+            const event_output_t *output = &outputs[e];
+            bool                  hit    = false;
+
+            switch (event->kind) {
+                case EVENT_TAP:
+                    hit = output->left_clicks == 1 && output->right_clicks == 0;
+                    break;
+                case EVENT_RIGHT:
+                    hit = output->right_clicks == 1 && output->left_clicks == 0;
+                    break;
+                case EVENT_DRAG:
+                    hit = output->dragged > 0 && output->right_clicks == 0;
+                    if (hit) {
+                        result->cost += travel_error(output);
+                    }
+                    break;
+                case EVENT_MOVE:
+                    hit = output->pointer > 0 && output->left_clicks == 0 && output->right_clicks == 0;
+                    if (hit) {
+                        result->cost += travel_error(output);
+                    }
+                    break;
+                case EVENT_SCROLL:
+                    hit = output->scroll > 0 && output->left_clicks == 0 && output->right_clicks == 0;
+                    if (hit && event->amount > 0) {
+                        result->cost += fmin(1.0, fabs((double)output->scroll - event->amount) / event->amount);
+                    }
+                    break;
+                case EVENT_ZOOM:
+                    hit = output->scroll == 0 && output->left_clicks == 0 && output->right_clicks == 0;
+                    break;
+                default:
+                    break;
+            }
+            result->missed += !hit;
+        }
+        free(outputs);
+    }
+
+    result->cost += result->missed + result->spurious;
+    result->done = 1;
+}
+
+// Ties go to the candidate closest to the firmware defaults
+static double default_distance(const candidate_t *candidate) {
+    double tap    = ((double)candidate->tap_distance_um - AZOTEQ_IQS7211E_TAP_DISTANCE_UM) / AZOTEQ_IQS7211E_TAP_DISTANCE_UM;
+    double scroll = ((double)candidate->scroll_step_um - AZOTEQ_IQS7211E_SCROLL_STEP_UM) / AZOTEQ_IQS7211E_SCROLL_STEP_UM;
+    double lock   = ((double)candidate->scroll_lock_um - AZOTEQ_IQS7211E_SCROLL_LOCK_UM) / AZOTEQ_IQS7211E_SCROLL_LOCK_UM;
+    double cutoff = ((double)candidate->min_cutoff_mhz - AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF) / AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF;
+    double beta   = ((double)candidate->beta - AZOTEQ_IQS7211E_FILTER_BETA) / (AZOTEQ_IQS7211E_FILTER_BETA > 0 ? AZOTEQ_IQS7211E_FILTER_BETA : 1);
+    return tap * tap + scroll * scroll + lock * lock + cutoff * cutoff + beta * beta;
+}
+
+static const result_t *sort_results;
+
+static int compare_candidates(const void *a, const void *b) {
+    size_t      ia = *(const size_t *)a, ib = *(const size_t *)b;
+    candidate_t ca = candidate_at(ia), cb = candidate_at(ib);
+
+    if (sort_results[ia].cost != sort_results[ib].cost) {
+        return sort_results[ia].cost < sort_results[ib].cost ? -1 : 1;
+    }
+    return default_distance(&ca) < default_distance(&cb) ? -1 : default_distance(&ca) > default_distance(&cb);
+}
+
+static void write_define(FILE *file, const char *name, unsigned value) {
+    fprintf(file, "#define %-40s 0x%02X\n", name, value);
+}
+
+static bool write_outputs(const char *prefix, const candidate_t *best, const result_t *result, size_t trace_count, size_t event_count) {
+    char path[256];
+
+    // The sensor's own tap gesture uses the same distance as the driver
+    azoteq_iqs7211e_tunables_init();
+    azoteq_iqs7211e_tunables_set(AZOTEQ_IQS7211E_TUNABLE_TAP_DISTANCE, um_to_counts(best->tap_distance_um));
+    const azoteq_iqs7211e_tunables_t *tunables = &azoteq_iqs7211e_tunables;
+
+    snprintf(path, sizeof(path), "%s.h", prefix);
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    fprintf(file, "/* Generated by tools/tune_search from %zu traces, %zu labelled events */\n", trace_count, event_count);
+    fprintf(file, "/* Cost %.2f: %u missed, %u spurious clicks */\n\n", result->cost, result->missed, result->spurious);
+    fprintf(file, "/* Driver Settings (config.h) */\n");
+    fprintf(file, "#define %-40s %u\n", "AZOTEQ_IQS7211E_TAP_DISTANCE_UM", best->tap_distance_um);
+    fprintf(file, "#define %-40s %u\n", "AZOTEQ_IQS7211E_SCROLL_STEP_UM", best->scroll_step_um);
+    fprintf(file, "#define %-40s %u\n", "AZOTEQ_IQS7211E_SCROLL_LOCK_UM", best->scroll_lock_um);
+    fprintf(file, "#define %-40s %u\n", "AZOTEQ_IQS7211E_FILTER_MIN_CUTOFF", best->min_cutoff_mhz);
+    fprintf(file, "#define %-40s %u\n\n", "AZOTEQ_IQS7211E_FILTER_BETA", best->beta);
+    fprintf(file, "/* Gesture Settings */\n/* Memory Map Position 0x4B - 0x55 */\n");
+    write_define(file, "GESTURE_ENABLE_0", GESTURE_ENABLE_0);
+    write_define(file, "GESTURE_ENABLE_1", GESTURE_ENABLE_1);
+    write_define(file, "TAP_TOUCH_TIME_0", tunables->tap_touch_time & 0xFF);
+    write_define(file, "TAP_TOUCH_TIME_1", tunables->tap_touch_time >> 8);
+    write_define(file, "TAP_WAIT_TIME_0", tunables->tap_wait_time & 0xFF);
+    write_define(file, "TAP_WAIT_TIME_1", tunables->tap_wait_time >> 8);
+    write_define(file, "TAP_DISTANCE_0", tunables->tap_distance & 0xFF);
+    write_define(file, "TAP_DISTANCE_1", tunables->tap_distance >> 8);
+    write_define(file, "HOLD_TIME_0", tunables->hold_time & 0xFF);
+    write_define(file, "HOLD_TIME_1", tunables->hold_time >> 8);
+    write_define(file, "SWIPE_TIME_0", tunables->swipe_time & 0xFF);
+    write_define(file, "SWIPE_TIME_1", tunables->swipe_time >> 8);
+    write_define(file, "SWIPE_X_DISTANCE_0", tunables->swipe_x_distance & 0xFF);
+    write_define(file, "SWIPE_X_DISTANCE_1", tunables->swipe_x_distance >> 8);
+    write_define(file, "SWIPE_Y_DISTANCE_0", tunables->swipe_y_distance & 0xFF);
+    write_define(file, "SWIPE_Y_DISTANCE_1", tunables->swipe_y_distance >> 8);
+    write_define(file, "SWIPE_X_CONS_DIST_0", SWIPE_X_CONS_DIST_0);
+    write_define(file, "SWIPE_X_CONS_DIST_1", SWIPE_X_CONS_DIST_1);
+    write_define(file, "SWIPE_Y_CONS_DIST_0", SWIPE_Y_CONS_DIST_0);
+    write_define(file, "SWIPE_Y_CONS_DIST_1", SWIPE_Y_CONS_DIST_1);
+    write_define(file, "SWIPE_ANGLE", SWIPE_ANGLE);
+    write_define(file, "PALM_THRESHOLD", tunables->palm_threshold);
+    fclose(file);
+
+    // Same bytes as the persisted block, loadable as is by azoteq_iqs7211e_tunables_init
+    snprintf(path, sizeof(path), "%s.bin", prefix);
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    fwrite(tunables, sizeof(*tunables), 1, file);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    long        jobs   = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *prefix = "tuned";
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "j:o:")) != -1) {
+        switch (opt) {
+            case 'j':
+                jobs = atol(optarg);
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-j jobs] [-o prefix] trace.txt [trace2.txt ...]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc || jobs < 1) {
+        fprintf(stderr, "usage: %s [-j jobs] [-o prefix] trace.txt [trace2.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    trace_t *traces      = calloc(argc - optind, sizeof(trace_t));
+    size_t   trace_count = 0, event_count = 0;
+    for (int i = optind; i < argc; i++) {
+        if (load_labelled_trace(argv[i], &traces[trace_count])) {
+            event_count += traces[trace_count++].event_count;
+        }
+    }
+    if (event_count == 0) {
+        fprintf(stderr, "no labelled events in the traces\n");
+        return 1;
+    }
+
+    sensor_reset();
+    azoteq_iqs7211e_init();
+    if (sensor_reset_pending()) {
+        fprintf(stderr, "init did not acknowledge the reset\n");
+        return 1;
+    }
+
+    size_t    candidate_count = (size_t)range_count(&tap_distance_range) * range_count(&scroll_step_range) * range_count(&scroll_lock_range) * range_count(&min_cutoff_range) * range_count(&beta_range);
+    result_t *results         = mmap(NULL, candidate_count * sizeof(result_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    printf("%zu traces, %zu labelled events, %zu candidates on %ld jobs\n", trace_count, event_count, candidate_count, jobs);
+
+    // Each child starts from the driver state right after init and reports through the shared map
+    long running = 0;
+    for (size_t c = 0; c < candidate_count; c++) {
+        if (running == jobs) {
+            wait(NULL);
+            running--;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            candidate_t candidate = candidate_at(c);
+            evaluate(traces, trace_count, &candidate, &results[c]);
+            _exit(0);
+        }
+        running++;
+    }
+    while (wait(NULL) > 0) {
+    }
+
+    size_t *order = malloc(candidate_count * sizeof(size_t));
+    size_t  valid = 0;
+    for (size_t c = 0; c < candidate_count; c++) {
+        if (results[c].done) {
+            order[valid++] = c;
+        }
+    }
+    if (valid < candidate_count) {
+        fprintf(stderr, "%zu candidates failed\n", candidate_count - valid);
+    }
+    if (valid == 0) {
+        return 1;
+    }
+    sort_results = results;
+    qsort(order, valid, sizeof(size_t), compare_candidates);
+
+    printf("%8s %8s %8s %8s %8s %8s %8s %8s\n", "cost", "missed", "spurious", "tap_um", "step_um", "lock_um", "cut_mhz", "beta");
+    for (size_t i = 0; i < valid && i < SHOW_BEST; i++) {
+        const result_t *result    = &results[order[i]];
+        candidate_t     candidate = candidate_at(order[i]);
+        printf("%8.2f %8u %8u %8u %8u %8u %8u %8u\n", result->cost, result->missed, result->spurious, candidate.tap_distance_um, candidate.scroll_step_um, candidate.scroll_lock_um, candidate.min_cutoff_mhz, candidate.beta);
+    }
+
+    candidate_t best = candidate_at(order[0]);
+    if (!write_outputs(prefix, &best, &results[order[0]], trace_count, event_count)) {
+        return 1;
+    }
+    printf("wrote %s.h and %s.bin\n", prefix, prefix);
+    return 0;
+}